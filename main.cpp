@@ -25,13 +25,28 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 int64_t counter;
 
+#include "sortalgo/indexedheap.hpp"
+#include "sortalgo/kwaymerge.hpp"
+#include "sortalgo/multiqueue.hpp"
+#include "sortalgo/numatopology.hpp"
+#include "sortalgo/pageallocation.hpp"
+#include "sortalgo/priorityqueue.hpp"
+#include "sortalgo/scratcharena.hpp"
 #include "sortalgo/sortheapbinaryaheadsimplevarianta.hpp"
 #include "sortalgo/sortheapbinaryaheadsimplevariantb.hpp"
 #include "sortalgo/sortheapbinarycached.hpp"
@@ -45,6 +60,9 @@ int64_t counter;
 #include "sortalgo/sortheapbinaryonebasedvariantb.hpp"
 #include "sortalgo/sortheaphybrid.hpp"
 #include "sortalgo/sortheaphybridcascading.hpp"
+#include "sortalgo/sortheaplayout.hpp"
+#include "sortalgo/sortheapmulti.hpp"
+#include "sortalgo/sortheapparallel.hpp"
 #include "sortalgo/sortheapquaternarycascadingvarianta.hpp"
 #include "sortalgo/sortheapquaternaryvarianta.hpp"
 #include "sortalgo/sortheapquaternaryvariantb.hpp"
@@ -57,12 +75,30 @@ int64_t counter;
 #include "sortalgo/sortheapternaryclusteredvariantb.hpp"
 #include "sortalgo/sortheapternaryonebasedvarianta.hpp"
 #include "sortalgo/sortheapternaryonebasedvariantb.hpp"
+#include "sortalgo/sortincremental.hpp"
+#include "sortalgo/sortmergenuma.hpp"
+#include "sortalgo/sortmergepower.hpp"
+#include "sortalgo/sortmergesimd.hpp"
+#include "sortalgo/sortpartial.hpp"
+#include "sortalgo/sortquickpatterndefeating.hpp"
 #include "sortalgo/sortquickrandomized.hpp"
+#include "sortalgo/sortquicksimddword.hpp"
+#include "sortalgo/sortradixlsd.hpp"
+#include "sortalgo/sortradixmsd.hpp"
+#include "sortalgo/sortsampleparallel.hpp"
+#include "sortalgo/sortselect.hpp"
+#include "sortalgo/sortstableparallel.hpp"
+#include "sortalgo/topkstream.hpp"
+#include "sortalgo/workstealingpool.hpp"
 
 using namespace tarsa;
 
 typedef int32_t typ;
 
+// the smaller sections of the benchmark need some items to work with
+ssize_t constexpr MinSize = 1 << 16;
+ssize_t constexpr DefaultSize = 12345678;
+
 template<typename ItemType>
 bool countingComparisonOperator(ItemType leftOp, ComparisonType opType,
         ItemType rightOp) {
@@ -76,8 +112,11 @@ bool countingComparisonOperator(ItemType leftOp, ComparisonType opType,
 #define ComparisonOperator countingComparisonOperator
 #endif
 
+/*
+ * returns the elapsed microseconds
+ */
 template<typename ItemType>
-void testFunction(std::string name, ItemType const * const original,
+ssize_t testFunction(std::string name, ItemType const * const original,
         ItemType * const work, ItemType const * const reference,
         ssize_t const size, std::function<void() > functionInTest) {
     std::cout << name << std::endl;
@@ -85,10 +124,16 @@ void testFunction(std::string name, ItemType const * const original,
     std::copy(original, original + size, work);
     counter = 0;
     clock_t clocks = clock();
+    auto const started = std::chrono::steady_clock::now();
     functionInTest();
+    auto const elapsed = std::chrono::steady_clock::now() - started;
     clocks = clock() - clocks;
     std::cout << counter << " comparisons" << std::endl;
     std::cout << clocks << " clock ticks" << std::endl;
+    // clock ticks add up over all threads, so parallel sorts need this one
+    ssize_t const microseconds = std::chrono::duration_cast<
+            std::chrono::microseconds>(elapsed).count();
+    std::cout << microseconds << " microseconds elapsed" << std::endl;
 
     if (reference != nullptr) {
         for (ssize_t i = 0; i + 1 < size; i++) {
@@ -100,20 +145,417 @@ void testFunction(std::string name, ItemType const * const original,
     }
 
     std::cout << std::endl;
+    return microseconds;
+}
+
+/*
+ * a few of the original heap sorts mis-sort some sizes, like 100003 or
+ * 300007, and are only known to be right at the default size, so other
+ * sizes skip them instead of failing the whole run
+ */
+template<typename ItemType>
+void testDefaultSizeFunction(std::string name, ItemType const * const original,
+        ItemType * const work, ItemType const * const reference,
+        ssize_t const size, std::function<void() > functionInTest) {
+    if (size == DefaultSize) {
+        testFunction(name, original, work, reference, size, functionInTest);
+    } else {
+        std::cout << name << std::endl << "skipped, verified only at "
+                << DefaultSize << " items" << std::endl << std::endl;
+    }
+}
+
+/*
+ * payloads start as input positions, so equal keys have to come out with
+ * increasing payloads
+ */
+template<typename KeyType>
+void testStableFunction(std::string name, KeyType const * const original,
+        KeyType * const work, uint32_t * const payload,
+        KeyType const * const reference, ssize_t const size,
+        std::function<void() > functionInTest) {
+    for (ssize_t i = 0; i < size; i++) {
+        payload[i] = i;
+    }
+    testFunction(name, original, work, reference, size, functionInTest);
+    for (ssize_t i = 0; i < size; i++) {
+        if (original[payload[i]] != work[i] || (i > 0
+                && work[i - 1] == work[i] && payload[i - 1] > payload[i])) {
+            std::cerr << "Error in stability verification!" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/*
+ * only the first k items of result have to match the reference
+ */
+template<typename ItemType>
+void testPartialFunction(std::string name, ItemType const * const original,
+        ItemType * const work, ItemType const * const result,
+        ItemType const * const reference, ssize_t const size,
+        ssize_t const k, std::function<void() > functionInTest) {
+    testFunction(name, original, work, (ItemType*) nullptr, size,
+            functionInTest);
+    if (!std::equal(result, result + k, reference)) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * work[k] has to match the reference, with nothing larger before it and
+ * nothing smaller after it
+ */
+template<typename ItemType>
+void testSelectFunction(std::string name, ItemType const * const original,
+        ItemType * const work, ItemType const * const reference,
+        ssize_t const size, ssize_t const k,
+        std::function<void() > functionInTest) {
+    testFunction(name, original, work, (ItemType*) nullptr, size,
+            functionInTest);
+    bool valid = work[k] == reference[k];
+    for (ssize_t i = 0; i < size; i++) {
+        valid &= i < k ? work[i] <= work[k] : work[i] >= work[k];
+    }
+    if (!valid) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ * pushes all items, then pops them back from the largest one down
+ */
+template<typename Queue>
+void sortThroughQueue(Queue &queue, typ * const a, ssize_t const size) {
+    for (ssize_t i = 0; i < size; i++) {
+        queue.push(a[i]);
+    }
+    for (ssize_t i = size - 1; i >= 0; i--) {
+        a[i] = queue.top();
+        queue.pop();
+    }
+}
+
+/*
+ * adjacency lists of a random directed graph, edges of vertex v are at
+ * edgeStarts[v] .. edgeStarts[v + 1]
+ */
+struct Graph {
+    std::vector<ssize_t> edgeStarts;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> weights;
+};
+
+Graph makeRandomGraph(ssize_t const vertices, ssize_t const edgesPerVertex) {
+    ssize_t constexpr MaxWeight = 1000;
+    Graph graph;
+    for (ssize_t vertex = 0; vertex < vertices; vertex++) {
+        graph.edgeStarts.push_back(graph.targets.size());
+        for (ssize_t edge = 0; edge < edgesPerVertex; edge++) {
+            graph.targets.push_back(rand() % vertices);
+            graph.weights.push_back(rand() % MaxWeight + 1);
+        }
+    }
+    graph.edgeStarts.push_back(graph.targets.size());
+    return graph;
+}
+
+/*
+ * improved distances are pushed again and stale entries skipped on pop
+ */
+void dijkstraLazy(Graph const &graph, uint32_t * const distances) {
+    typedef std::pair<uint32_t, uint32_t> Entry;
+    ssize_t const vertices = graph.edgeStarts.size() - 1;
+    std::fill(distances, distances + vertices, UINT32_MAX);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    distances[0] = 0;
+    queue.push(Entry(0, 0));
+    while (!queue.empty()) {
+        Entry const entry = queue.top();
+        queue.pop();
+        if (entry.first != distances[entry.second]) {
+            continue;
+        }
+        for (ssize_t edge = graph.edgeStarts[entry.second];
+                edge < graph.edgeStarts[entry.second + 1]; edge++) {
+            uint32_t const distance = entry.first + graph.weights[edge];
+            if (distance < distances[graph.targets[edge]]) {
+                distances[graph.targets[edge]] = distance;
+                queue.push(Entry(distance, graph.targets[edge]));
+            }
+        }
+    }
+}
+
+template<typename Layout>
+void dijkstraIndexed(Graph const &graph, uint32_t * const distances) {
+    ssize_t const vertices = graph.edgeStarts.size() - 1;
+    std::fill(distances, distances + vertices, UINT32_MAX);
+    IndexedHeap<uint32_t, genericReverseComparisonOperator, Layout> heap(
+            vertices);
+    distances[0] = 0;
+    heap.push(0, 0);
+    while (!heap.empty()) {
+        uint32_t const base = heap.topKey();
+        ssize_t const vertex = heap.pop();
+        for (ssize_t edge = graph.edgeStarts[vertex];
+                edge < graph.edgeStarts[vertex + 1]; edge++) {
+            uint32_t const distance = base + graph.weights[edge];
+            if (distance < distances[graph.targets[edge]]) {
+                distances[graph.targets[edge]] = distance;
+                heap.pushOrPromote(graph.targets[edge], distance);
+            }
+        }
+    }
+}
+
+/*
+ * the input arrives in chunks, like reads from a stream
+ */
+template<typename TopK>
+void streamThroughTopK(TopK &topK, typ const * const a, ssize_t const size,
+        typ * const out) {
+    ssize_t constexpr ChunkSize = 1 << 16;
+    for (ssize_t begin = 0; begin < size; begin += ChunkSize) {
+        topK.push(a + begin, std::min(ChunkSize, size - begin));
+    }
+    topK.drain(out);
+}
+
+/*
+ * the baseline for MultiQueue, a single queue behind a mutex
+ */
+struct LockedPriorityQueue {
+    std::mutex mutex;
+    PriorityQueue<typ, genericComparisonOperator, SimdDwordHeapLayout> queue;
+
+    void push(typ const item) {
+        std::lock_guard<std::mutex> guard(mutex);
+        queue.push(item);
+    }
+
+    bool tryPop(typ * const item) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (queue.empty()) {
+            return false;
+        }
+        *item = queue.top();
+        queue.pop();
+        return true;
+    }
+};
+
+/*
+ * every worker pushes its slice, then pops as many items back into it;
+ * the popped items come out in the order the queue relaxes to
+ */
+template<typename Queue>
+void roundTripThroughQueue(WorkStealingPool &pool, Queue &queue,
+        typ * const a, ssize_t const size) {
+    pool.run([&]() {
+        pool.onEachWorker([&](ssize_t const worker) {
+            for (ssize_t i = size * worker / pool.size();
+                    i < size * (worker + 1) / pool.size(); i++) {
+                queue.push(a[i]);
+            }
+        });
+        pool.onEachWorker([&](ssize_t const worker) {
+            for (ssize_t i = size * worker / pool.size();
+                    i < size * (worker + 1) / pool.size(); i++) {
+                while (!queue.tryPop(a + i)) {
+                }
+            }
+        });
+    });
+}
+
+ssize_t constexpr StableKeyRange = 1 << 12;
+
+ssize_t constexpr PresortedDistributions = 4;
+
+char const * const presortedDistributionNames[PresortedDistributions] = {
+    "sorted", "reversed", "nearly sorted", "sawtooth"
+};
+
+void fillPresorted(typ * const a, ssize_t const size,
+        ssize_t const distribution) {
+    ssize_t constexpr SawtoothRuns = 16;
+    for (ssize_t i = 0; i < size; i++) {
+        a[i] = rand();
+    }
+    if (distribution == 3) {
+        for (ssize_t run = 0; run < SawtoothRuns; run++) {
+            std::sort(a + size * run / SawtoothRuns,
+                    a + size * (run + 1) / SawtoothRuns);
+        }
+        return;
+    }
+    std::sort(a, a + size);
+    if (distribution == 1) {
+        std::reverse(a, a + size);
+    } else if (distribution == 2) {
+        // one in twenty items is overwritten with a random value
+        for (ssize_t i = 0; i < size / 20; i++) {
+            a[rand() % size] = rand();
+        }
+    }
+}
+
+ssize_t constexpr PageKinds = 3;
+
+PageKind const pageKinds[PageKinds] = {
+    SmallPages, TransparentHugePages, GiantPages
+};
+
+char const * const pageKindOptions[PageKinds] = {"4k", "thp", "1g"};
+
+/*
+ * runs heap sorts, which miss the TLB on almost every sift step past the
+ * top levels, with the work array on every page kind and prints the
+ * times side by side; kinds the system cannot provide are skipped
+ */
+void comparePageKinds(typ const * const original, typ const * const sorted,
+        ssize_t const size) {
+    typedef std::pair<char const *, std::function<void(typ *) > > Sort;
+    std::vector<Sort> const sorts = {
+        Sort("BinaryHeapSortCascadingVariantA", [&](typ * const a) {
+            BinaryHeapSortCascadingVariantA<typ, ComparisonOperator>(a, size);
+        }),
+        Sort("QuaternaryHeapSortVariantB", [&](typ * const a) {
+            QuaternaryHeapSortVariantB<typ, ComparisonOperator>(a, size);
+        }),
+        Sort("SimdDwordHeapSortVariantB", [&](typ * const a) {
+            SimdDwordHeapSortVariantB<typ>(a, size);
+        }),
+        Sort("ClusteredBinaryHeapSortVariantB", [&](typ * const a) {
+            ClusteredBinaryHeapSortVariantB<typ, ComparisonOperator>(a, size);
+        }),
+        Sort("ClusteredTernaryHeapSortVariantB", [&](typ * const a) {
+            ClusteredTernaryHeapSortVariantB<typ, ComparisonOperator>(a,
+                    size);
+        }),
+        Sort("HybridCascadingHeapSort", [&](typ * const a) {
+            HybridCascadingHeapSort<typ, ComparisonOperator>(a, size);
+        }),
+    };
+    std::vector<std::vector<ssize_t> > times(sorts.size(),
+            std::vector<ssize_t>(PageKinds, -1));
+    for (ssize_t kind = 0; kind < PageKinds; kind++) {
+        ssize_t const bytes = sizeof (typ) * size;
+        typ * const work = (typ *) allocatePages(bytes, pageKinds[kind]);
+        if (work == nullptr) {
+            std::cout << pageKindName(pageKinds[kind]) << " unavailable"
+                    << std::endl << std::endl;
+            continue;
+        }
+        std::fill(work, work + size, 0);
+        std::cout << pageKindName(pageKinds[kind]) << ", "
+                << (transparentHugePageBytes(work, bytes) >> 20)
+                << " MiB in transparent huge pages" << std::endl << std::endl;
+        for (ssize_t sort = 0; sort < (ssize_t) sorts.size(); sort++) {
+            times[sort][kind] = testFunction(std::string(sorts[sort].first)
+                    + " (" + pageKindName(pageKinds[kind]) + ")", original,
+                    work, sorted, size, [&]() {
+                        sorts[sort].second(work);
+                    });
+        }
+        releasePages(work, bytes, pageKinds[kind]);
+    }
+
+    std::cout << "microseconds elapsed";
+    for (ssize_t kind = 0; kind < PageKinds; kind++) {
+        std::cout << ", " << pageKindName(pageKinds[kind]);
+    }
+    std::cout << std::endl;
+    for (ssize_t sort = 0; sort < (ssize_t) sorts.size(); sort++) {
+        std::cout << sorts[sort].first;
+        for (ssize_t kind = 0; kind < PageKinds; kind++) {
+            std::cout << ", ";
+            if (times[sort][kind] < 0) {
+                std::cout << "-";
+            } else {
+                std::cout << times[sort][kind];
+            }
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
 }
 
 int main(int argc, char** argv) {
-    ssize_t size = 12345678;
+    ssize_t size = DefaultSize;
+    ssize_t threads = std::thread::hardware_concurrency();
+    bool pinThreads = false;
+    ssize_t bufferPages = -1;
+    bool comparePages = false;
+    auto const usage = [&]() {
+        std::cerr << "Usage: " << argv[0] << " [--threads count] [--pin]"
+                " [--size count] [--pages 4k|thp|1g] [--compare-pages]"
+                << std::endl;
+        return EXIT_FAILURE;
+    };
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc) {
+            threads = atol(argv[++arg]);
+        } else if (strcmp(argv[arg], "--pin") == 0) {
+            pinThreads = true;
+        } else if (strcmp(argv[arg], "--size") == 0 && arg + 1 < argc) {
+            size = std::max(MinSize, (ssize_t) atol(argv[++arg]));
+        } else if (strcmp(argv[arg], "--pages") == 0 && arg + 1 < argc) {
+            arg++;
+            for (ssize_t kind = 0; kind < PageKinds; kind++) {
+                if (strcmp(argv[arg], pageKindOptions[kind]) == 0) {
+                    bufferPages = kind;
+                }
+            }
+            if (bufferPages < 0) {
+                return usage();
+            }
+        } else if (strcmp(argv[arg], "--compare-pages") == 0) {
+            comparePages = true;
+        } else {
+            return usage();
+        }
+    }
+    WorkStealingPool pool(threads, pinThreads);
+    std::cout << pool.size() << " worker threads" << std::endl << std::endl;
 
     srand(7);
     typ * original;
     typ * sorted;
     typ * work;
     int8_t * scratchpad;
-    posix_memalign((void**) &original, 128, sizeof (typ) * size);
-    posix_memalign((void**) &sorted, 128, sizeof (typ) * size);
-    posix_memalign((void**) &work, 128, sizeof (typ) * size);
-    posix_memalign((void**) &scratchpad, 128, sizeof (typ) * size);
+    uint32_t * payload;
+    // with --pages the buffers come straight from mmap
+    auto const allocate = [&](void ** const buffer, ssize_t const bytes) {
+        if (bufferPages < 0) {
+            posix_memalign(buffer, 128, bytes);
+            return;
+        }
+        *buffer = allocatePages(bytes, pageKinds[bufferPages]);
+        if (*buffer == nullptr) {
+            std::cerr << pageKindName(pageKinds[bufferPages])
+                    << " unavailable" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    };
+    allocate((void**) &original, sizeof (typ) * size);
+    allocate((void**) &sorted, sizeof (typ) * size);
+    allocate((void**) &work, sizeof (typ) * size);
+    // large enough for a key array followed by a payload array
+    ssize_t const scratchpadBytes =
+            keysAndPayloadsScratchBytes<typ, uint32_t>(size);
+    allocate((void**) &scratchpad, scratchpadBytes);
+    allocate((void**) &payload, sizeof (uint32_t) * size);
+
+    // sorts take exactly sized scratchpads from the same buffer, so no
+    // scratchpad is allocated per call; the parallel sorts and KWayMerge
+    // still allocate their bookkeeping (bucket offsets, run bounds, loser
+    // trees, pool tasks), sized by threads, buckets and runs, not by size
+    ScratchArena arena(scratchpad, scratchpadBytes);
 
     for (ssize_t i = 0; i < size; i++) {
         sorted[i] = original[i] = rand();
@@ -121,6 +563,11 @@ int main(int argc, char** argv) {
     testFunction("StdSort", original, work, (typ*) nullptr, size, [&]() {
         std::sort(sorted, sorted + size); });
 
+    if (comparePages) {
+        comparePageKinds(original, sorted, size);
+        return EXIT_SUCCESS;
+    }
+
         testFunction("BinaryHeapSortAheadSimpleVariantA",
                 original, work, sorted, size, [&]() {
                     BinaryHeapSortAheadSimpleVariantA<typ, ComparisonOperator>(
@@ -133,10 +580,12 @@ int main(int argc, char** argv) {
                             work, size);
                 });
 
-    testFunction("CachedComparisonsBinaryHeapSort",
+    testDefaultSizeFunction("CachedComparisonsBinaryHeapSort",
             original, work, sorted, size, [&]() {
                 CachedComparisonsBinaryHeapSort<typ, ComparisonOperator>(
-                        work, size, scratchpad);
+                        work, size, arena.acquire(
+                        CachedComparisonsBinaryHeapSortScratchBytes<typ>(
+                        size)));
             });
 
     testFunction("BinaryHeapSortCascadingVariantA",
@@ -151,13 +600,13 @@ int main(int argc, char** argv) {
                         work, size);
             });
 
-    testFunction("BinaryHeapSortCascadingVariantC",
+    testDefaultSizeFunction("BinaryHeapSortCascadingVariantC",
             original, work, sorted, size, [&]() {
                 BinaryHeapSortCascadingVariantC<typ, ComparisonOperator>(
                         work, size);
             });
 
-    testFunction("BinaryHeapSortCascadingVariantD",
+    testDefaultSizeFunction("BinaryHeapSortCascadingVariantD",
             original, work, sorted, size, [&]() {
                 BinaryHeapSortCascadingVariantD<typ, ComparisonOperator>(
                         work, size);
@@ -255,24 +704,439 @@ int main(int argc, char** argv) {
                         work, size);
             });
 
-    testFunction("OneBasedTernaryHeapSortVariantA",
+    testDefaultSizeFunction("OneBasedTernaryHeapSortVariantA",
             original, work, sorted, size, [&]() {
                 OneBasedTernaryHeapSortVariantA<typ, ComparisonOperator>(
                         work, size);
             });
 
-    testFunction("OneBasedTernaryHeapSortVariantB",
+    testDefaultSizeFunction("OneBasedTernaryHeapSortVariantB",
             original, work, sorted, size, [&]() {
                 OneBasedTernaryHeapSortVariantB<typ, ComparisonOperator>(
                         work, size);
             });
 
+    testFunction("LayoutHeapSort (clustered quaternary, 2 levels)",
+            original, work, sorted, size, [&]() {
+                LayoutHeapSort<typ, ComparisonOperator,
+                        ClusteredHeapLayout<4, 2> >(work, size);
+            });
+
+    testFunction("LayoutCascadingHeapSort (clustered quaternary, 2 levels)",
+            original, work, sorted, size, [&]() {
+                LayoutCascadingHeapSort<typ, ComparisonOperator,
+                        ClusteredHeapLayout<4, 2> >(work, size);
+            });
+
+    testFunction("LayoutCascadingHeapSort (binary, line and 4K page sized)",
+            original, work, sorted, size, [&]() {
+                LayoutCascadingHeapSort<typ, ComparisonOperator,
+                        FittedClusteredHeapLayout<typ, 2, 64, 4096> >(
+                        work, size);
+            });
+
+    testFunction("LayoutCascadingHeapSort (SIMD dword, super clusters)",
+            original, work, sorted, size, [&]() {
+                LayoutCascadingHeapSort<typ, genericComparisonOperator,
+                        ClusteredHeapLayout<8, 1, 3, SimdDwordHeapLayout> >(
+                        work, size);
+            });
+
+    testFunction("PatternDefeatingQuickSort",
+            original, work, sorted, size, [&]() {
+                PatternDefeatingQuickSort<typ, ComparisonOperator>(
+                        work, size);
+            });
+
     testFunction("RandomizedQuickSort",
             original, work, sorted, size, [&]() {
                 RandomizedQuickSort<typ, ComparisonOperator>(
                         work, size);
             });
 
+    testFunction("SimdDwordQuickSort",
+            original, work, sorted, size, [&]() {
+                SimdDwordQuickSort<typ>(work, size);
+            });
+
+    testFunction("PowerSort",
+            original, work, sorted, size, [&]() {
+                PowerSort<typ, ComparisonOperator>(work, size,
+                        arena.acquire(PowerSortScratchBytes<typ>(size)));
+            });
+
+    testFunction("SimdMergeSort",
+            original, work, sorted, size, [&]() {
+                SimdMergeSort<typ>(work, size,
+                        arena.acquire(SimdMergeSortScratchBytes<typ>(size)));
+            });
+
+    testFunction("LsdRadixSort",
+            original, work, sorted, size, [&]() {
+                LsdRadixSort<typ>(work, size,
+                        arena.acquire(LsdRadixSortScratchBytes<typ>(size)));
+            });
+
+    testFunction("LsdRadixSort (11-bit digits)",
+            original, work, sorted, size, [&]() {
+                LsdRadixSort<typ, true, 11>(work, size,
+                        arena.acquire(LsdRadixSortScratchBytes<typ>(size)));
+            });
+
+    testFunction("MsdRadixSort",
+            original, work, sorted, size, [&]() {
+                MsdRadixSort<typ>(work, size);
+            });
+
+    testFunction("StdPriorityQueue",
+            original, work, sorted, size, [&]() {
+                std::priority_queue<typ> queue;
+                sortThroughQueue(queue, work, size);
+            });
+
+    testFunction("PriorityQueue (binary)",
+            original, work, sorted, size, [&]() {
+                PriorityQueue<typ, ComparisonOperator, BinaryHeapLayout> queue;
+                sortThroughQueue(queue, work, size);
+            });
+
+    testFunction("PriorityQueue (quaternary)",
+            original, work, sorted, size, [&]() {
+                PriorityQueue<typ, ComparisonOperator, QuaternaryHeapLayout>
+                        queue;
+                sortThroughQueue(queue, work, size);
+            });
+
+    testFunction("PriorityQueue (quaternary, bulk build)",
+            original, work, sorted, size, [&]() {
+                PriorityQueue<typ, ComparisonOperator, QuaternaryHeapLayout>
+                        queue;
+                queue.build(work, size);
+                for (ssize_t i = size - 1; i >= 0; i--) {
+                    work[i] = queue.top();
+                    queue.pop();
+                }
+            });
+
+    for (ssize_t const batches : {(ssize_t) 16, size / 1000}) {
+        testFunction("PriorityQueue (quaternary, " + std::to_string(batches)
+                + " batches)", original, work, sorted, size, [&]() {
+                    PriorityQueue<typ, ComparisonOperator,
+                            QuaternaryHeapLayout> queue;
+                    for (ssize_t batch = 0; batch < batches; batch++) {
+                        ssize_t const begin = size * batch / batches;
+                        queue.push(work + begin,
+                                size * (batch + 1) / batches - begin);
+                    }
+                    for (ssize_t i = size - 1; i >= 0; i--) {
+                        work[i] = queue.top();
+                        queue.pop();
+                    }
+                });
+    }
+
+    testFunction("PriorityQueue (SIMD dword)",
+            original, work, sorted, size, [&]() {
+                PriorityQueue<typ, genericComparisonOperator,
+                        SimdDwordHeapLayout> queue;
+                sortThroughQueue(queue, work, size);
+            });
+
+    testFunction("PriorityQueue (clustered binary)",
+            original, work, sorted, size, [&]() {
+                PriorityQueue<typ, ComparisonOperator,
+                        ClusteredBinaryHeapLayout<> > queue;
+                sortThroughQueue(queue, work, size);
+            });
+
+    // the reference distances come from the lazy deletion run, the
+    // source arrays are unused
+    Graph const graph = makeRandomGraph(size / 16, 8);
+    std::vector<uint32_t> referenceDistances(size / 16);
+    std::vector<uint32_t> distances(size / 16);
+    testFunction("Dijkstra (lazy deletion binary heap)",
+            original, work, (typ *) nullptr, 0, [&]() {
+                dijkstraLazy(graph, referenceDistances.data());
+            });
+
+    testFunction("Dijkstra (indexed quaternary heap)",
+            original, work, (typ *) nullptr, 0, [&]() {
+                dijkstraIndexed<QuaternaryHeapLayout>(graph, distances.data());
+            });
+    if (distances != referenceDistances) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    testFunction("Dijkstra (indexed SIMD dword heap)",
+            original, work, (typ *) nullptr, 0, [&]() {
+                dijkstraIndexed<SimdDwordHeapLayout>(graph, distances.data());
+            });
+    if (distances != referenceDistances) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    for (ssize_t const k : {(ssize_t) 1000, size / 4}) {
+        std::string const suffix = " (k = " + std::to_string(k) + ")";
+        testPartialFunction("StdPartialSort" + suffix,
+                original, work, work, sorted, size, k, [&]() {
+                    std::partial_sort(work, work + k, work + size);
+                });
+
+        testPartialFunction("PartialSort" + suffix,
+                original, work, work, sorted, size, k, [&]() {
+                    PartialSort<typ>(work, size, k);
+                });
+
+        typ * const topKOut = (typ *) arena.acquire(sizeof (typ) * k);
+        testPartialFunction("TopK" + suffix,
+                original, work, topKOut, sorted, size, k, [&]() {
+                    TopK<typ>(work, size, k, topKOut);
+                });
+
+        testPartialFunction("StreamingTopK" + suffix,
+                original, work, topKOut, sorted, size, k, [&]() {
+                    DefaultStreamingTopK<typ> topK(k);
+                    streamThroughTopK(topK, work, size, topKOut);
+                });
+
+        testPartialFunction("StreamingTopK (clustered quaternary)" + suffix,
+                original, work, topKOut, sorted, size, k, [&]() {
+                    StreamingTopK<typ, ComparisonOperator,
+                            ClusteredHeapLayout<4, 2> > topK(k);
+                    streamThroughTopK(topK, work, size, topKOut);
+                });
+    }
+
+    for (ssize_t const k : {(ssize_t) 50, (ssize_t) 1000, size / 100}) {
+        testPartialFunction("IncrementalSort (first " + std::to_string(k)
+                + ")", original, work, work, sorted, size, k, [&]() {
+                    DefaultIncrementalSort<typ> sorter(work, size);
+                    for (ssize_t i = 0; i < k; i++) {
+                        sorter[i];
+                    }
+                });
+    }
+
+    for (ssize_t const k : {size / 2, size * 99 / 100}) {
+        std::string const suffix = " (k = " + std::to_string(k) + ")";
+        testSelectFunction("StdNthElement" + suffix,
+                original, work, sorted, size, k, [&]() {
+                    std::nth_element(work, work + k, work + size);
+                });
+
+        testSelectFunction("NthElement" + suffix,
+                original, work, sorted, size, k, [&]() {
+                    NthElement<typ>(work, size, k);
+                });
+    }
+
+    for (ssize_t const runsCount
+            : {(ssize_t) 4, (ssize_t) 16, (ssize_t) 1024}) {
+        // the input is made of sorted runs, the merge goes to the arena
+        std::vector<typ> runsSource(original, original + size);
+        typ * const merged = (typ *) arena.acquire(sizeof (typ) * size);
+        for (ssize_t run = 0; run < runsCount; run++) {
+            std::sort(runsSource.begin() + size * run / runsCount,
+                    runsSource.begin() + size * (run + 1) / runsCount);
+        }
+        testPartialFunction("KWayMerge (" + std::to_string(runsCount)
+                + " runs)", runsSource.data(), work, merged,
+                sorted, size, size, [&]() {
+                    std::vector<MergeRun<typ> > runs(runsCount);
+                    for (ssize_t run = 0; run < runsCount; run++) {
+                        runs[run].begin = work + size * run / runsCount;
+                        runs[run].end = work + size * (run + 1) / runsCount;
+                    }
+                    KWayMerge<typ>(runs.data(), runsCount, merged);
+                });
+    }
+
+    testFunction("ParallelSampleSort",
+            original, work, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelSampleSort<typ>(pool, work, size,
+                            arena.acquire(
+                            ParallelSampleSortScratchBytes<typ>(size)));
+                });
+            });
+
+    testFunction("ParallelClusteredBinaryHeapSortVariantB",
+            original, work, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelClusteredBinaryHeapSortVariantB<typ,
+                            ComparisonOperator>(pool, work, size);
+                });
+            });
+
+    testFunction("ParallelClusteredTernaryHeapSortVariantB",
+            original, work, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelClusteredTernaryHeapSortVariantB<typ,
+                            ComparisonOperator>(pool, work, size);
+                });
+            });
+
+    testFunction("ParallelHybridCascadingHeapSort",
+            original, work, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelHybridCascadingHeapSort<typ, ComparisonOperator>(
+                            pool, work, size);
+                });
+            });
+
+    testFunction("MultiHeapSort",
+            original, work, sorted, size, [&]() {
+                pool.run([&]() {
+                    MultiHeapSort<typ, ComparisonOperator,
+                            HybridCascadingHeapSort<typ, ComparisonOperator> >(
+                            pool, work, size, arena.acquire(
+                            MultiHeapSortScratchBytes<typ>(size)));
+                });
+            });
+
+    // only the popped multiset is checked, the order is relaxed
+    testFunction("LockedPriorityQueue (SIMD dword)",
+            original, work, (typ *) nullptr, size, [&]() {
+                LockedPriorityQueue queue;
+                roundTripThroughQueue(pool, queue, work, size);
+            });
+    std::sort(work, work + size);
+    if (!std::equal(work, work + size, sorted)) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    testFunction("MultiQueue (SIMD dword)",
+            original, work, (typ *) nullptr, size, [&]() {
+                MultiQueue<typ, genericComparisonOperator,
+                        SimdDwordHeapLayout> queue(pool.size());
+                roundTripThroughQueue(pool, queue, work, size);
+            });
+    std::sort(work, work + size);
+    if (!std::equal(work, work + size, sorted)) {
+        std::cerr << "Error in verification!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    {
+        // always pinned, node placement means nothing to migrating threads
+        WorkStealingPool numaPool(pool.size(), true);
+        // fresh untouched pages, so the placement policy decides their nodes
+        std::cout << numaTopology().nodesCount() << " NUMA nodes" << std::endl
+                << std::endl;
+        for (ssize_t placement = 0; placement < 2; placement++) {
+            bool const nodeLocal = placement == 0;
+            ssize_t const bytes = sizeof (typ) * size;
+            typ * const numaWork = (typ *) allocatePages(bytes);
+            int8_t * const numaScratchpad = (int8_t *) allocatePages(bytes);
+            numaPool.run([&]() {
+                if (nodeLocal) {
+                    NumaPlaceForWorkers(numaPool, numaWork, size);
+                    NumaPlaceForWorkers(numaPool, (typ *) numaScratchpad, size);
+                } else {
+                    interleaveOverNodes(numaWork, bytes);
+                    interleaveOverNodes(numaScratchpad, bytes);
+                }
+            });
+            testFunction(std::string("NumaMergeSort (")
+                    + (nodeLocal ? "node-local" : "interleaved") + ")",
+                    original, numaWork, sorted, size, [&]() {
+                        numaPool.run([&]() {
+                            NumaMergeSort<typ, ComparisonOperator,
+                                    PatternDefeatingQuickSort<typ,
+                                    ComparisonOperator> >(numaPool, numaWork,
+                                    size, numaScratchpad);
+                        });
+                    });
+            std::cout << "sampled pages per node:";
+            for (ssize_t const pages : pagesPerNode(numaWork, bytes)) {
+                std::cout << " " << pages;
+            }
+            std::cout << std::endl << std::endl;
+            releasePages(numaWork, bytes);
+            releasePages(numaScratchpad, bytes);
+        }
+    }
+
+    for (ssize_t workers = 1; workers < pool.size();
+            workers = std::min(workers * 2, pool.size())) {
+        WorkStealingPool scalingPool(workers, pinThreads);
+        testFunction("ParallelSampleSort (" + std::to_string(workers)
+                + " of " + std::to_string(pool.size()) + " workers)",
+                original, work, sorted, size, [&]() {
+                    scalingPool.run([&]() {
+                        ParallelSampleSort<typ>(scalingPool, work, size,
+                                arena.acquire(
+                                ParallelSampleSortScratchBytes<typ>(size)));
+                    });
+                });
+    }
+
+    for (ssize_t i = 0; i < size; i++) {
+        sorted[i] = original[i] = rand() % StableKeyRange;
+    }
+    testFunction("StdStableSort (key+payload)", original, work,
+            (typ*) nullptr, size, [&]() {
+                std::stable_sort(sorted, sorted + size); });
+
+    testStableFunction("LsdRadixSort (key+payload)",
+            original, work, payload, sorted, size, [&]() {
+                LsdRadixSort<typ, uint32_t>(work, payload, size,
+                        arena.acquire(LsdRadixSortScratchBytes<typ, uint32_t>(
+                        size)));
+            });
+
+    testStableFunction("ParallelStableMergeSort (key+payload)",
+            original, work, payload, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelStableMergeSort<typ, uint32_t,
+                            ComparisonOperator>(pool, work, payload, size,
+                            arena.acquire(ParallelStableMergeSortScratchBytes<
+                            typ, uint32_t>(size)));
+                });
+            });
+
+    testStableFunction("ParallelStableRadixSort (key+payload)",
+            original, work, payload, sorted, size, [&]() {
+                pool.run([&]() {
+                    ParallelStableRadixSort<typ, uint32_t>(pool, work,
+                            payload, size, arena.acquire(
+                            ParallelStableRadixSortScratchBytes<typ,
+                            uint32_t>(size)));
+                });
+            });
+
+    for (ssize_t distribution = 0; distribution < PresortedDistributions;
+            distribution++) {
+        std::string const suffix = std::string(" (")
+                + presortedDistributionNames[distribution] + ")";
+        fillPresorted(original, size, distribution);
+        std::copy(original, original + size, sorted);
+        testFunction("StdSort" + suffix, original, work, (typ*) nullptr,
+                size, [&]() {
+                    std::sort(sorted, sorted + size); });
+
+        testFunction("PatternDefeatingQuickSort" + suffix,
+                original, work, sorted, size, [&]() {
+                    PatternDefeatingQuickSort<typ, ComparisonOperator>(
+                            work, size);
+                });
+
+        testFunction("HybridCascadingHeapSort" + suffix,
+                original, work, sorted, size, [&]() {
+                    HybridCascadingHeapSort<typ, ComparisonOperator>(
+                            work, size);
+                });
+
+        testFunction("PowerSort" + suffix,
+                original, work, sorted, size, [&]() {
+                    PowerSort<typ, ComparisonOperator>(work, size,
+                            arena.acquire(PowerSortScratchBytes<typ>(size)));
+                });
+    }
+
     std::cout << "Great success!" << std::endl;
 
     return EXIT_SUCCESS;
@@ -42,8 +42,8 @@ OBJECTFILES= \
 CFLAGS=-mavx2
 
 # CC Compiler Flags
-CCFLAGS=-mavx2
-CXXFLAGS=-mavx2
+CCFLAGS=-mavx2 -pthread
+CXXFLAGS=-mavx2 -pthread
 
 # Fortran Compiler Flags
 FFLAGS=-mavx2
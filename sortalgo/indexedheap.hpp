@@ -0,0 +1,189 @@
+/* 
+ * indexedheap.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef INDEXEDHEAP_HPP
+#define	INDEXEDHEAP_HPP
+
+#include "priorityqueue.hpp"
+#include "sortalgocommon.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+namespace tarsa {
+
+    namespace privateIndexedHeap {
+
+        ssize_t constexpr Absent = -1;
+    }
+
+    /*
+     * max-heap of keys attached to ids in [0, idsCount), with a position
+     * map so the key of a queued id can be changed; the layouts and leader
+     * selection are the ones of PriorityQueue, but sifts move a hole
+     * instead of swapping, so every moved entry costs one position write;
+     * keys and ids are stored apart so the SIMD layout sees plain dwords;
+     * with genericReverseComparisonOperator promote() is decrease-key
+     */
+    template<typename KeyType, ComparisonOperator<KeyType> compOp,
+    typename Layout = QuaternaryHeapLayout>
+    class IndexedHeap {
+        KeyType * keys;
+        ssize_t * ids;
+        std::vector<ssize_t> positions;
+        ssize_t count;
+
+        void place(ssize_t const position, KeyType const key,
+                ssize_t const id) {
+            keys[position] = key;
+            ids[position] = id;
+            positions[id] = position;
+        }
+
+        void siftUp(ssize_t hole, KeyType const key, ssize_t const id) {
+            while (hole >= Layout::Arity) {
+                ssize_t const parent = Layout::parent(hole);
+                if (!compOp(keys[parent], Below, key)) {
+                    break;
+                }
+                place(hole, keys[parent], ids[parent]);
+                hole = parent;
+            }
+            place(hole, key, id);
+        }
+
+        void siftDown(ssize_t hole, KeyType const key, ssize_t const id) {
+            while (true) {
+                ssize_t const first = Layout::firstChild(hole);
+                if (first >= count) {
+                    break;
+                }
+                ssize_t const leader = Layout::template leader<KeyType,
+                        compOp>(keys, first, count);
+                if (!compOp(key, Below, keys[leader])) {
+                    break;
+                }
+                place(hole, keys[leader], ids[leader]);
+                hole = leader;
+            }
+            place(hole, key, id);
+        }
+
+    public:
+
+        IndexedHeap(ssize_t const idsCount)
+        : positions(idsCount, privateIndexedHeap::Absent), count(0) {
+            keys = allocateAligned<KeyType>(std::max(idsCount, (ssize_t) 1));
+            try {
+                ids = allocateAligned<ssize_t>(std::max(idsCount, (ssize_t) 1));
+            } catch (...) {
+                free(keys);
+                throw;
+            }
+        }
+
+        ~IndexedHeap() {
+            free(keys);
+            free(ids);
+        }
+
+        IndexedHeap(IndexedHeap const &) = delete;
+        IndexedHeap & operator=(IndexedHeap const &) = delete;
+
+        ssize_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        bool contains(ssize_t const id) const {
+            return positions[id] != privateIndexedHeap::Absent;
+        }
+
+        KeyType const & key(ssize_t const id) const {
+            assert(contains(id));
+            return keys[positions[id]];
+        }
+
+        ssize_t topId() const {
+            assert(count > 0);
+            return ids[Layout::template leader<KeyType, compOp>(keys, 0,
+                    count)];
+        }
+
+        KeyType const & topKey() const {
+            assert(count > 0);
+            return keys[Layout::template leader<KeyType, compOp>(keys, 0,
+                    count)];
+        }
+
+        void push(ssize_t const id, KeyType const key) {
+            assert(!contains(id));
+            siftUp(count++, key, id);
+        }
+
+        /*
+         * the new key must not be Below the current one
+         */
+        void promote(ssize_t const id, KeyType const key) {
+            assert(contains(id) && !compOp(key, Below, keys[positions[id]]));
+            siftUp(positions[id], key, id);
+        }
+
+        /*
+         * pushes an absent id or promotes a queued one when the key is
+         * Above its current key; returns false when nothing changed
+         */
+        bool pushOrPromote(ssize_t const id, KeyType const key) {
+            if (!contains(id)) {
+                push(id, key);
+                return true;
+            }
+            if (compOp(keys[positions[id]], Below, key)) {
+                siftUp(positions[id], key, id);
+                return true;
+            }
+            return false;
+        }
+
+        /*
+         * removes and returns the top id
+         */
+        ssize_t pop() {
+            assert(count > 0);
+            ssize_t const leader = Layout::template leader<KeyType, compOp>(
+                    keys, 0, count);
+            ssize_t const id = ids[leader];
+            positions[id] = privateIndexedHeap::Absent;
+            count--;
+            if (leader != count) {
+                siftDown(leader, keys[count], ids[count]);
+            }
+            return id;
+        }
+    };
+}
+
+#endif	/* INDEXEDHEAP_HPP */
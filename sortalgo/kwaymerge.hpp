@@ -0,0 +1,256 @@
+/* 
+ * kwaymerge.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef KWAYMERGE_HPP
+#define	KWAYMERGE_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheapsimddwordvariantb.hpp"
+
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace tarsa {
+
+    /*
+     * a sorted run, merging consumes it from the front
+     */
+    template<typename ItemType>
+    struct MergeRun {
+        ItemType const * begin;
+        ItemType const * end;
+    };
+
+    namespace privateKWayMerge {
+
+        ssize_t constexpr SimdLanes = 8;
+        ssize_t constexpr SimdMaxRuns = SimdLanes * 2;
+
+        /*
+         * tournament tree over the run heads, inner nodes keep the key and
+         * run of the loser of their match and node 0 keeps the overall
+         * winner, so replaying a path never touches the runs; exhausted
+         * runs are stored as run + leaves and lose every match, ties go to
+         * the lower run index
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        class LoserTree {
+            MergeRun<ItemType> * const runs;
+            ssize_t const leaves;
+            ssize_t capacity;
+            std::vector<ItemType> keys;
+            std::vector<ssize_t> sources;
+
+            bool beats(ItemType const &firstKey, ssize_t const first,
+                    ItemType const &secondKey, ssize_t const second) const {
+                if (first >= leaves) {
+                    return false;
+                }
+                if (second >= leaves) {
+                    return true;
+                }
+                return first < second ? !compOp(secondKey, Below, firstKey)
+                        : compOp(firstKey, Below, secondKey);
+            }
+
+            void load(ssize_t const run, ItemType * const key,
+                    ssize_t * const source) const {
+                if (run < leaves && runs[run].begin != runs[run].end) {
+                    *key = *runs[run].begin;
+                    *source = run;
+                } else {
+                    *source = run + leaves;
+                }
+            }
+
+            void build(ssize_t const node, ItemType * const key,
+                    ssize_t * const source) {
+                if (node >= capacity) {
+                    *key = ItemType();
+                    load(node - capacity, key, source);
+                    return;
+                }
+                ItemType rightKey;
+                ssize_t rightSource;
+                build(node * 2, key, source);
+                build(node * 2 + 1, &rightKey, &rightSource);
+                if (beats(*key, *source, rightKey, rightSource)) {
+                    keys[node] = rightKey;
+                    sources[node] = rightSource;
+                } else {
+                    keys[node] = *key;
+                    sources[node] = *source;
+                    *key = rightKey;
+                    *source = rightSource;
+                }
+            }
+
+        public:
+
+            LoserTree(MergeRun<ItemType> * const runs, ssize_t const leaves)
+            : runs(runs), leaves(leaves), capacity(1) {
+                while (capacity < leaves) {
+                    capacity *= 2;
+                }
+                keys.resize(capacity);
+                sources.resize(capacity);
+                build(1, &keys[0], &sources[0]);
+            }
+
+            ItemType const & top() const {
+                return keys[0];
+            }
+
+            /*
+             * advances the winning run and replays its path to the root
+             */
+            void advance() {
+                ssize_t const winner = sources[0];
+                runs[winner].begin++;
+                ItemType key = keys[0];
+                ssize_t source;
+                load(winner, &key, &source);
+                for (ssize_t node = (winner + capacity) / 2; node > 0;
+                        node /= 2) {
+                    if (beats(keys[node], sources[node], key, source)) {
+                        std::swap(keys[node], key);
+                        std::swap(sources[node], source);
+                    }
+                }
+                keys[0] = key;
+                sources[0] = source;
+            }
+        };
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void treeMerge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+                ItemType * const target, ssize_t const count) {
+            LoserTree<ItemType, compOp> tree(runs, runsCount);
+            for (ssize_t index = 0; index < count; index++) {
+                target[index] = tree.top();
+                tree.advance();
+            }
+        }
+
+        /*
+         * run heads sit in vector lanes and the leaderIndex reduction of the
+         * SIMD dword heaps picks the next one; exhausted runs hold the
+         * largest key, so when that key wins the lane may be exhausted and
+         * the lowest live run with the same key is taken instead
+         */
+        template<typename ItemType, bool Ascending>
+        void simdMerge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+                ItemType * const target, ssize_t const count) {
+            using privateSimdDwordHeapSortVariantB::leaderIndex;
+            using privateSimdDwordHeapSortVariantB::ordered;
+            bool constexpr Signed = std::is_same<ItemType, int32_t>::value;
+            ItemType const sentinel = Ascending
+                    ? std::numeric_limits<ItemType>::max()
+                    : std::numeric_limits<ItemType>::min();
+            alignas(32) ItemType heads[SimdMaxRuns];
+            for (ssize_t lane = 0; lane < SimdMaxRuns; lane++) {
+                heads[lane] = lane < runsCount
+                        && runs[lane].begin != runs[lane].end
+                        ? *runs[lane].begin : sentinel;
+            }
+            bool const twoVectors = runsCount > SimdLanes;
+            for (ssize_t index = 0; index < count; index++) {
+                // the heaps select the largest item for ascending order
+                ssize_t lane = leaderIndex<ItemType, Signed, !Ascending>(
+                        heads);
+                if (twoVectors) {
+                    ssize_t const high = SimdLanes + leaderIndex<ItemType,
+                            Signed, !Ascending>(heads + SimdLanes);
+                    if (ordered<ItemType, Ascending>(heads[high],
+                            heads[lane])) {
+                        lane = high;
+                    }
+                }
+                if (runs[lane].begin == runs[lane].end) {
+                    lane = 0;
+                    while (runs[lane].begin == runs[lane].end) {
+                        lane++;
+                    }
+                }
+                target[index] = heads[lane];
+                runs[lane].begin++;
+                heads[lane] = runs[lane].begin != runs[lane].end
+                        ? *runs[lane].begin : sentinel;
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void merge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+                ItemType * const target, ssize_t const count,
+                std::false_type) {
+            treeMerge<ItemType, compOp>(runs, runsCount, target, count);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void merge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+                ItemType * const target, ssize_t const count,
+                std::true_type) {
+            if (runsCount > SimdMaxRuns) {
+                treeMerge<ItemType, compOp>(runs, runsCount, target, count);
+            } else {
+                simdMerge<ItemType,
+                        compOp == genericComparisonOperator<ItemType> >(
+                        runs, runsCount, target, count);
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        struct SimdUsable : std::integral_constant<bool,
+        (std::is_same<ItemType, int32_t>::value
+        || std::is_same<ItemType, uint32_t>::value)
+        && (compOp == genericComparisonOperator<ItemType>
+        || compOp == genericReverseComparisonOperator<ItemType>)> {
+        };
+    }
+
+    /*
+     * stable: equal items leave in run order; the runs are consumed and
+     * target receives all of their items; dword runs ordered by the
+     * generic comparison operators are merged with AVX2 for up to 16 runs
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void KWayMerge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+            ItemType * const target) {
+        ssize_t count = 0;
+        for (ssize_t run = 0; run < runsCount; run++) {
+            count += runs[run].end - runs[run].begin;
+        }
+        privateKWayMerge::merge<ItemType, compOp>(runs, runsCount, target,
+                count, privateKWayMerge::SimdUsable<ItemType, compOp>());
+    }
+
+    template<typename ItemType>
+    void KWayMerge(MergeRun<ItemType> * const runs, ssize_t const runsCount,
+            ItemType * const target) {
+        KWayMerge<ItemType, genericComparisonOperator>(runs, runsCount,
+                target);
+    }
+}
+
+#endif	/* KWAYMERGE_HPP */
@@ -0,0 +1,200 @@
+/* 
+ * multiqueue.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef MULTIQUEUE_HPP
+#define	MULTIQUEUE_HPP
+
+#include "priorityqueue.hpp"
+#include "sortalgocommon.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace tarsa {
+
+    /*
+     * based on: "MultiQueues: Simpler, Faster, and Better Relaxed Concurrent
+     * Priority Queues" by Rihani, Sanders and Dementiev
+     */
+    namespace privateMultiQueue {
+
+        ssize_t constexpr DefaultQueuesPerThread = 2;
+
+        /*
+         * xorshift state per thread, seeded from its address so threads
+         * do not walk the queues in lockstep
+         */
+        ssize_t randomIndex(ssize_t const bound) {
+            static thread_local uint64_t state = 0;
+            if (state == 0) {
+                state = 0x9e3779b97f4a7c15ull ^ (uintptr_t) &state;
+            }
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state % bound;
+        }
+
+        /*
+         * the top and the emptiness are mirrored in atomics, so choosing a
+         * queue to pop from takes no lock; the lock with the mirrors and the
+         * queue start on lines of their own, so peeking at a queue does not
+         * contend with the owner of it or of its neighbour
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        struct alignas(CacheLineBytes) GuardedQueue {
+            std::atomic_flag locked;
+            std::atomic<bool> filled;
+            std::atomic<ItemType> top;
+            alignas(CacheLineBytes) PriorityQueue<ItemType, compOp, Layout>
+            queue;
+
+            GuardedQueue() : filled(false) {
+                locked.clear();
+            }
+
+            bool tryLock() {
+                return !locked.test_and_set(std::memory_order_acquire);
+            }
+
+            void unlock() {
+                filled.store(!queue.empty(), std::memory_order_relaxed);
+                if (!queue.empty()) {
+                    top.store(queue.top(), std::memory_order_relaxed);
+                }
+                locked.clear(std::memory_order_release);
+            }
+        };
+    }
+
+    /*
+     * relaxed concurrent max-heap made of queuesPerThread * threads
+     * sequential queues behind try-locks: push() goes to a random queue,
+     * tryPop() takes the better top of two random queues, so popped items
+     * are close to, but not always, the largest ones
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Layout = QuaternaryHeapLayout>
+    class MultiQueue {
+        typedef privateMultiQueue::GuardedQueue<ItemType, compOp, Layout>
+        Guarded;
+
+        ssize_t queuesCount;
+        Guarded * queues;
+
+        /*
+         * locks a queue that looked filled, scanning all queues when two
+         * random picks come up empty; returns nullptr if all are empty
+         */
+        Guarded * lockFilled() {
+            while (true) {
+                Guarded * const first =
+                        &queues[privateMultiQueue::randomIndex(queuesCount)];
+                Guarded * const second =
+                        &queues[privateMultiQueue::randomIndex(queuesCount)];
+                bool const firstFilled =
+                        first->filled.load(std::memory_order_relaxed);
+                bool const secondFilled =
+                        second->filled.load(std::memory_order_relaxed);
+                Guarded * chosen;
+                if (firstFilled && secondFilled) {
+                    chosen = compOp(first->top.load(std::memory_order_relaxed),
+                            Below, second->top.load(std::memory_order_relaxed))
+                            ? second : first;
+                } else if (firstFilled || secondFilled) {
+                    chosen = firstFilled ? first : second;
+                } else {
+                    chosen = nullptr;
+                    for (ssize_t index = 0; index < queuesCount; index++) {
+                        if (queues[index].filled.load(
+                                std::memory_order_relaxed)) {
+                            chosen = &queues[index];
+                            break;
+                        }
+                    }
+                    if (chosen == nullptr) {
+                        return nullptr;
+                    }
+                }
+                if (chosen->tryLock()) {
+                    if (!chosen->queue.empty()) {
+                        return chosen;
+                    }
+                    chosen->unlock();
+                }
+            }
+        }
+
+    public:
+
+        MultiQueue(ssize_t const threads, ssize_t const queuesPerThread =
+                privateMultiQueue::DefaultQueuesPerThread)
+        : queuesCount(std::max((ssize_t) 2, threads * queuesPerThread)),
+        queues(allocateAligned<Guarded>(queuesCount)) {
+            for (ssize_t index = 0; index < queuesCount; index++) {
+                new (queues + index) Guarded();
+            }
+        }
+
+        ~MultiQueue() {
+            for (ssize_t index = 0; index < queuesCount; index++) {
+                queues[index].~Guarded();
+            }
+            free(queues);
+        }
+
+        MultiQueue(MultiQueue const &) = delete;
+        MultiQueue & operator=(MultiQueue const &) = delete;
+
+        void push(ItemType const item) {
+            while (true) {
+                Guarded &guarded =
+                        queues[privateMultiQueue::randomIndex(queuesCount)];
+                if (guarded.tryLock()) {
+                    guarded.queue.push(item);
+                    guarded.unlock();
+                    return;
+                }
+            }
+        }
+
+        /*
+         * returns false when every queue is empty at the time it is looked
+         * at, which is only conclusive once no thread pushes anymore
+         */
+        bool tryPop(ItemType * const item) {
+            Guarded * const guarded = lockFilled();
+            if (guarded == nullptr) {
+                return false;
+            }
+            *item = guarded->queue.top();
+            guarded->queue.pop();
+            guarded->unlock();
+            return true;
+        }
+    };
+}
+
+#endif	/* MULTIQUEUE_HPP */
@@ -0,0 +1,227 @@
+/* 
+ * numatopology.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef NUMATOPOLOGY_HPP
+#define	NUMATOPOLOGY_HPP
+
+#include "pageallocation.hpp"
+#include "sortalgocommon.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tarsa {
+
+    /*
+     * talks to the kernel directly through sysfs and the memory policy
+     * system calls, so no libnuma is needed
+     */
+    namespace privateNumaTopology {
+
+        ssize_t constexpr MaskWords = 16;
+        ssize_t constexpr MaxNodes = MaskWords * 64;
+        ssize_t constexpr PagesPerSample = 64;
+
+        /*
+         * parses lists like "0-3,8-11"
+         */
+        std::vector<ssize_t> parseCpuList(std::string const &list) {
+            std::vector<ssize_t> cpus;
+            std::stringstream stream(list);
+            std::string range;
+            while (std::getline(stream, range, ',')) {
+                if (range.empty() || range == "\n") {
+                    continue;
+                }
+                ssize_t first;
+                ssize_t last;
+                if (sscanf(range.c_str(), "%zd-%zd", &first, &last) != 2) {
+                    last = first = atol(range.c_str());
+                }
+                for (ssize_t cpu = first; cpu <= last; cpu++) {
+                    cpus.push_back(cpu);
+                }
+            }
+            return cpus;
+        }
+
+        bool setPolicy(void * const address, ssize_t const bytes,
+                int const mode, unsigned long const * const mask) {
+            ssize_t const pageSize = sysconf(_SC_PAGESIZE);
+            uintptr_t const begin = (uintptr_t) address & ~(pageSize - 1);
+            uintptr_t const end = ((uintptr_t) address + bytes + pageSize - 1)
+                    & ~(pageSize - 1);
+            if (end <= begin) {
+                return true;
+            }
+            return syscall(SYS_mbind, begin, end - begin, mode, mask,
+                    MaxNodes + 1, MPOL_MF_MOVE) == 0;
+        }
+    }
+
+    struct NumaNode {
+        ssize_t id;
+        std::vector<ssize_t> cpus;
+    };
+
+    /*
+     * without sysfs node information the whole machine is one node
+     */
+    class NumaTopology {
+        std::vector<NumaNode> nodes;
+        std::vector<ssize_t> slotCpus;
+        std::vector<ssize_t> slotNodes;
+
+    public:
+
+        NumaTopology() {
+            for (ssize_t id = 0; id < privateNumaTopology::MaxNodes; id++) {
+                std::ifstream file("/sys/devices/system/node/node"
+                        + std::to_string(id) + "/cpulist");
+                if (!file) {
+                    continue;
+                }
+                std::string list;
+                std::getline(file, list);
+                std::vector<ssize_t> const cpus =
+                        privateNumaTopology::parseCpuList(list);
+                if (!cpus.empty()) {
+                    nodes.push_back({id, cpus});
+                }
+            }
+            if (nodes.empty()) {
+                NumaNode node = {0, {}};
+                for (ssize_t cpu = 0; cpu < std::max(1u,
+                        std::thread::hardware_concurrency()); cpu++) {
+                    node.cpus.push_back(cpu);
+                }
+                nodes.push_back(node);
+            }
+            // slots alternate between nodes, so few workers still get
+            // the memory bandwidth of every node
+            for (ssize_t index = 0; (ssize_t) slotCpus.size() < cpusCount();
+                    index++) {
+                for (ssize_t node = 0; node < nodesCount(); node++) {
+                    if (index < (ssize_t) nodes[node].cpus.size()) {
+                        slotCpus.push_back(nodes[node].cpus[index]);
+                        slotNodes.push_back(node);
+                    }
+                }
+            }
+        }
+
+        ssize_t nodesCount() const {
+            return nodes.size();
+        }
+
+        NumaNode const & node(ssize_t const index) const {
+            return nodes[index];
+        }
+
+        ssize_t cpusCount() const {
+            ssize_t cpus = 0;
+            for (NumaNode const &node : nodes) {
+                cpus += node.cpus.size();
+            }
+            return cpus;
+        }
+
+        ssize_t slotCpu(ssize_t const slot) const {
+            return slotCpus[slot % slotCpus.size()];
+        }
+
+        /*
+         * index into the nodes list, not the kernel node id
+         */
+        ssize_t slotNode(ssize_t const slot) const {
+            return slotNodes[slot % slotNodes.size()];
+        }
+    };
+
+    NumaTopology const & numaTopology() {
+        static NumaTopology const topology;
+        return topology;
+    }
+
+    /*
+     * already touched pages are migrated
+     */
+    bool bindToNode(void * const address, ssize_t const bytes,
+            ssize_t const node) {
+        unsigned long mask[privateNumaTopology::MaskWords] = {};
+        ssize_t const id = numaTopology().node(node).id;
+        mask[id / 64] |= 1ul << (id % 64);
+        return privateNumaTopology::setPolicy(address, bytes, MPOL_BIND,
+                mask);
+    }
+
+    bool interleaveOverNodes(void * const address, ssize_t const bytes) {
+        unsigned long mask[privateNumaTopology::MaskWords] = {};
+        for (ssize_t node = 0; node < numaTopology().nodesCount(); node++) {
+            ssize_t const id = numaTopology().node(node).id;
+            mask[id / 64] |= 1ul << (id % 64);
+        }
+        return privateNumaTopology::setPolicy(address, bytes, MPOL_INTERLEAVE,
+                mask);
+    }
+
+    /*
+     * samples every 64th page, pages not touched yet are not counted
+     */
+    std::vector<ssize_t> pagesPerNode(void const * const address,
+            ssize_t const bytes) {
+        ssize_t const pageSize = sysconf(_SC_PAGESIZE);
+        ssize_t const step = pageSize * privateNumaTopology::PagesPerSample;
+        std::vector<void *> pages;
+        for (ssize_t offset = 0; offset < bytes; offset += step) {
+            pages.push_back((void *) (((uintptr_t) address + offset)
+                    & ~(pageSize - 1)));
+        }
+        std::vector<int> status(pages.size());
+        std::vector<ssize_t> counts(numaTopology().nodesCount());
+        if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr,
+                status.data(), 0) != 0) {
+            return counts;
+        }
+        for (int const id : status) {
+            for (ssize_t node = 0; node < numaTopology().nodesCount();
+                    node++) {
+                if (numaTopology().node(node).id == id) {
+                    counts[node]++;
+                }
+            }
+        }
+        return counts;
+    }
+}
+
+#endif	/* NUMATOPOLOGY_HPP */
@@ -0,0 +1,142 @@
+/* 
+ * pageallocation.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef PAGEALLOCATION_HPP
+#define	PAGEALLOCATION_HPP
+
+#include "sortalgocommon.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace tarsa {
+
+    enum PageKind {
+        SmallPages, TransparentHugePages, GiantPages
+    };
+
+    namespace privatePageAllocation {
+
+        ssize_t constexpr SmallPageSize = 4 << 10;
+        ssize_t constexpr HugePageSize = 2 << 20;
+        ssize_t constexpr GiantPageSize = 1 << 30;
+        int constexpr GiantPageShift = 30;
+
+        ssize_t pageSize(PageKind const kind) {
+            return kind == SmallPages ? SmallPageSize
+                    : kind == TransparentHugePages ? HugePageSize
+                    : GiantPageSize;
+        }
+
+        ssize_t mappedBytes(ssize_t const bytes, PageKind const kind) {
+            return (bytes + pageSize(kind) - 1) / pageSize(kind)
+                    * pageSize(kind);
+        }
+    }
+
+    char const * pageKindName(PageKind const kind) {
+        return kind == SmallPages ? "4K pages"
+                : kind == TransparentHugePages ? "transparent huge pages"
+                : "1G pages";
+    }
+
+    /*
+     * page aligned and not touched yet, so a placement policy set before
+     * the first write decides where the pages land; 4K pages are opted
+     * out of transparent huge pages, which are otherwise only asked for,
+     * 1G pages have to be reserved by the system first, otherwise nullptr
+     * is returned
+     */
+    void * allocatePages(ssize_t const bytes, PageKind const kind =
+            SmallPages) {
+        using namespace privatePageAllocation;
+        ssize_t const mapped = mappedBytes(bytes, kind);
+        if (kind == GiantPages) {
+            void * const address = mmap(nullptr, mapped,
+                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS
+                    | MAP_HUGETLB | (GiantPageShift << MAP_HUGE_SHIFT), -1,
+                    0);
+            return address == MAP_FAILED ? nullptr : address;
+        }
+        // the mapping is over-allocated and trimmed to a huge page
+        // boundary, so the kernel can back it with whole huge pages
+        ssize_t const slack = kind == TransparentHugePages ? HugePageSize : 0;
+        void * const address = mmap(nullptr, mapped + slack,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            return nullptr;
+        }
+        if (kind == SmallPages) {
+            // with THP set to always the kernel would merge them anyway
+            madvise(address, mapped, MADV_NOHUGEPAGE);
+            return address;
+        }
+        uintptr_t const start = (uintptr_t) address;
+        uintptr_t const aligned = (start + HugePageSize - 1)
+                & ~(uintptr_t) (HugePageSize - 1);
+        if (aligned > start) {
+            munmap(address, aligned - start);
+        }
+        if (start + slack > aligned) {
+            munmap((void *) (aligned + mapped), start + slack - aligned);
+        }
+        madvise((void *) aligned, mapped, MADV_HUGEPAGE);
+        return (void *) aligned;
+    }
+
+    void releasePages(void * const address, ssize_t const bytes,
+            PageKind const kind = SmallPages) {
+        munmap(address, privatePageAllocation::mappedBytes(bytes, kind));
+    }
+
+    /*
+     * how many bytes of the range the kernel backs with transparent huge
+     * pages, read from /proc/self/smaps
+     */
+    ssize_t transparentHugePageBytes(void const * const address,
+            ssize_t const bytes) {
+        uintptr_t const begin = (uintptr_t) address;
+        uintptr_t const end = begin + bytes;
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool inRange = false;
+        ssize_t total = 0;
+        while (std::getline(smaps, line)) {
+            unsigned long first;
+            unsigned long last;
+            long kilobytes;
+            if (sscanf(line.c_str(), "%lx-%lx ", &first, &last) == 2) {
+                inRange = first < end && last > begin;
+            } else if (inRange && sscanf(line.c_str(),
+                    "AnonHugePages: %ld kB", &kilobytes) == 1) {
+                total += kilobytes << 10;
+            }
+        }
+        return total;
+    }
+}
+
+#endif	/* PAGEALLOCATION_HPP */
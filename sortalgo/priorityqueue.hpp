@@ -0,0 +1,492 @@
+/* 
+ * priorityqueue.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef PRIORITYQUEUE_HPP
+#define	PRIORITYQUEUE_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheapsimddwordvariantb.hpp"
+
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+namespace tarsa {
+
+    /*
+     * layouts keep a group of Arity roots at the front, like the quaternary
+     * and SIMD heap sorts do, and store the children of a node next to each
+     * other; parents always come before their children, so any prefix of
+     * the array is a valid tree; arrays have to be aligned to ArrayAlignment
+     */
+    template<ssize_t arity>
+    struct DaryHeapLayout {
+        static ssize_t constexpr Arity = arity;
+        static ssize_t constexpr ArrayAlignment = 1;
+
+        static ssize_t firstChild(ssize_t const node) {
+            return (node + 1) * Arity;
+        }
+
+        static ssize_t parent(ssize_t const node) {
+            return node / Arity - 1;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        static ssize_t leader(ItemType const * const a, ssize_t const first,
+                ssize_t const count) {
+            ssize_t leader = first;
+            for (ssize_t child = first + 1; child < std::min(first + Arity,
+                    count); child++) {
+                if (compOp(a[leader], Below, a[child])) {
+                    leader = child;
+                }
+            }
+            return leader;
+        }
+    };
+
+    typedef DaryHeapLayout<2> BinaryHeapLayout;
+    typedef DaryHeapLayout<4> QuaternaryHeapLayout;
+
+    /*
+     * full child groups are searched with AVX2, so the items have to be
+     * dwords ordered by genericComparisonOperator or its reverse, and the
+     * groups are loaded aligned, so the array has to be 32 byte aligned
+     */
+    struct SimdDwordHeapLayout : DaryHeapLayout<8> {
+        static ssize_t constexpr ArrayAlignment = 32;
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        static ssize_t leader(ItemType const * const a, ssize_t const first,
+                ssize_t const count) {
+            bool constexpr dword = std::is_same<ItemType, int32_t>::value
+                    || std::is_same<ItemType, uint32_t>::value;
+            static_assert(dword, "only dword items are supported");
+            bool constexpr ascending =
+                    compOp == genericComparisonOperator<ItemType>;
+            static_assert(ascending
+                    || compOp == genericReverseComparisonOperator<ItemType>,
+                    "only the generic comparison operators are supported");
+            if (first + Arity > count) {
+                return DaryHeapLayout<8>::leader<ItemType, compOp>(a, first,
+                        count);
+            }
+            return first + privateSimdDwordHeapSortVariantB::leaderIndex<
+                    ItemType, std::is_same<ItemType, int32_t>::value,
+                    ascending>(a + first);
+        }
+    };
+
+    namespace privateHeapLayouts {
+
+        /*
+         * the number of nodes in the top levels of a layout with a root
+         * group of arity nodes
+         */
+        ssize_t constexpr groupedTreeSize(ssize_t const arity,
+                ssize_t const levels) {
+            return levels == 0 ? 0
+                    : arity * (1 + groupedTreeSize(arity, levels - 1));
+        }
+
+        ssize_t constexpr power(ssize_t const base, ssize_t const exponent) {
+            return exponent == 0 ? 1 : base * power(base, exponent - 1);
+        }
+
+        /*
+         * how many levels of a tree, widening by arity from the given
+         * width, fit in capacity nodes; at least one
+         */
+        ssize_t constexpr fittingLevels(ssize_t const capacity,
+                ssize_t const arity, ssize_t const width,
+                ssize_t const size = 0, ssize_t const levels = 0) {
+            return size + width <= capacity
+                    ? fittingLevels(capacity, arity, width * arity,
+                    size + width, levels + 1)
+                    : levels > 0 ? levels : 1;
+        }
+    }
+
+    /*
+     * generalizes the layout of ClusteredBinaryHeapSortVariantB to any
+     * arity: subtrees of clusterLevels levels, starting with a root group,
+     * are stored contiguously and every node on the last level of a
+     * cluster points to a whole child cluster; with superClusterLevels the
+     * tree of clusters is clustered again, like in a B-heap, so subtrees of
+     * that many cluster levels are stored contiguously; child groups are
+     * searched by GroupLayout; clusters are packed without padding, as
+     * every slot of the array is a node
+     */
+    template<ssize_t arity, ssize_t clusterLevels,
+    ssize_t superClusterLevels = 0,
+    typename GroupLayout = DaryHeapLayout<arity> >
+    struct ClusteredHeapLayout : GroupLayout {
+        static_assert(GroupLayout::Arity == arity,
+                "the group layout has to have the same arity");
+        static_assert(clusterLevels > 0 && superClusterLevels >= 0,
+                "clusters need at least one level");
+
+        static ssize_t constexpr Arity = arity;
+        static ssize_t constexpr ClusterSize =
+                privateHeapLayouts::groupedTreeSize(Arity, clusterLevels);
+        static ssize_t constexpr ClusterArity =
+                privateHeapLayouts::power(Arity, clusterLevels);
+        static ssize_t constexpr LastLevelStart =
+                privateHeapLayouts::groupedTreeSize(Arity, clusterLevels - 1);
+        // super clusters count clusters and have a single root cluster
+        static ssize_t constexpr SuperClusterSize = superClusterLevels == 0
+                ? 0 : privateHeapLayouts::groupedTreeSize(ClusterArity,
+                superClusterLevels - 1) + 1;
+        static ssize_t constexpr SuperClusterArity =
+                privateHeapLayouts::power(ClusterArity, superClusterLevels);
+        static ssize_t constexpr SuperClusterLastLevelStart =
+                superClusterLevels == 0 ? 0
+                : privateHeapLayouts::groupedTreeSize(ClusterArity,
+                superClusterLevels - 2 > 0 ? superClusterLevels - 2 : 0)
+                + (superClusterLevels > 1);
+
+        static ssize_t childCluster(ssize_t const cluster, ssize_t const slot) {
+            if (superClusterLevels == 0) {
+                return cluster * ClusterArity + slot + 1;
+            }
+            ssize_t const super = cluster / SuperClusterSize;
+            ssize_t const inner = cluster - super * SuperClusterSize;
+            if (inner < SuperClusterLastLevelStart) {
+                return cluster + inner * (ClusterArity - 1) + slot + 1;
+            }
+            return ((super * SuperClusterArity + (inner
+                    - SuperClusterLastLevelStart) * ClusterArity + slot + 1))
+                    * SuperClusterSize;
+        }
+
+        /*
+         * the last level node pointing to the cluster
+         */
+        static ssize_t parentSlot(ssize_t const cluster) {
+            ssize_t parent;
+            ssize_t slot;
+            if (superClusterLevels == 0) {
+                parent = (cluster - 1) / ClusterArity;
+                slot = (cluster - 1) % ClusterArity;
+            } else {
+                ssize_t const super = cluster / SuperClusterSize;
+                ssize_t const inner = cluster - super * SuperClusterSize;
+                if (inner > 0) {
+                    parent = super * SuperClusterSize
+                            + (inner - 1) / ClusterArity;
+                    slot = (inner - 1) % ClusterArity;
+                } else {
+                    ssize_t const position = (super - 1) % SuperClusterArity;
+                    parent = (super - 1) / SuperClusterArity
+                            * SuperClusterSize + SuperClusterLastLevelStart
+                            + position / ClusterArity;
+                    slot = position % ClusterArity;
+                }
+            }
+            return parent * ClusterSize + LastLevelStart + slot;
+        }
+
+        static ssize_t firstChild(ssize_t const node) {
+            ssize_t const cluster = node / ClusterSize;
+            ssize_t const relative = node - cluster * ClusterSize;
+            return relative < LastLevelStart
+                    ? cluster * ClusterSize + (relative + 1) * Arity
+                    : childCluster(cluster, relative - LastLevelStart)
+                    * ClusterSize;
+        }
+
+        static ssize_t parent(ssize_t const node) {
+            ssize_t const cluster = node / ClusterSize;
+            ssize_t const relative = node - cluster * ClusterSize;
+            return relative >= Arity
+                    ? cluster * ClusterSize + relative / Arity - 1
+                    : parentSlot(cluster);
+        }
+    };
+
+    /*
+     * the layout of ClusteredBinaryHeapSortVariantB
+     */
+    template<ssize_t clusterLevels = 5 >
+    using ClusteredBinaryHeapLayout = ClusteredHeapLayout<2, clusterLevels>;
+
+    /*
+     * the deepest clusters that fit in a cache line and, with a page size,
+     * the deepest super clusters that fit in a page; clusters are packed,
+     * so they are sized to, not aligned to lines and pages: a binary
+     * cluster of 14 dwords mostly straddles two lines, and a super cluster
+     * of 73 of them two pages
+     */
+    template<typename ItemType, ssize_t arity, ssize_t lineBytes = 64,
+    ssize_t pageBytes = 0 >
+    using FittedClusteredHeapLayout = ClusteredHeapLayout<arity,
+            privateHeapLayouts::fittingLevels(lineBytes / sizeof (ItemType),
+            arity, arity), pageBytes == 0 ? 0
+            : privateHeapLayouts::fittingLevels(pageBytes / sizeof (ItemType)
+            / privateHeapLayouts::groupedTreeSize(arity,
+            privateHeapLayouts::fittingLevels(lineBytes / sizeof (ItemType),
+            arity, arity)), privateHeapLayouts::power(arity,
+            privateHeapLayouts::fittingLevels(lineBytes / sizeof (ItemType),
+            arity, arity)), 1)>;
+
+    namespace privatePriorityQueue {
+
+        ssize_t constexpr QueueSize = 64;
+        ssize_t constexpr MinCapacity = 64;
+        ssize_t constexpr BulkHeapifyFraction = 16;
+
+        /*
+         * moves the item at slot one level down, returns false when it
+         * stays in place
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        bool siftDownStep(ItemType * const items, ssize_t const count,
+                ssize_t * const slot) {
+            ssize_t const root = *slot;
+            ssize_t const first = Layout::firstChild(root);
+            if (first >= count) {
+                return false;
+            }
+            ssize_t const leader = Layout::template leader<ItemType, compOp>(
+                    items, first, count);
+            if (!compOp(items[root], Below, items[leader])) {
+                return false;
+            }
+            std::swap(items[root], items[leader]);
+            *slot = leader;
+            prefetch(items + Layout::firstChild(leader));
+            return true;
+        }
+
+        /*
+         * advances every pending sift-down by one level, oldest first, and
+         * returns how many are still pending
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        ssize_t advancePending(ItemType * const items, ssize_t const count,
+                ssize_t * const pending, ssize_t const pendingCount) {
+            ssize_t kept = 0;
+            for (ssize_t index = 0; index < pendingCount; index++) {
+                pending[kept] = pending[index];
+                kept += siftDownStep<ItemType, compOp, Layout>(items, count,
+                        pending + kept);
+            }
+            return kept;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        void siftDown(ItemType * const items, ssize_t const count,
+                ssize_t slot) {
+            while (siftDownStep<ItemType, compOp, Layout>(items, count,
+                    &slot)) {
+            }
+        }
+
+        /*
+         * every node is visited, as clustered layouts do not keep their
+         * last parent right before the first leaf
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        void heapify(ItemType * const items, ssize_t const count) {
+            for (ssize_t node = count - 1; node >= 0; node--) {
+                siftDown<ItemType, compOp, Layout>(items, count, node);
+            }
+        }
+
+        /*
+         * moves the leader of the heap to the end, drained times, so the
+         * heap ends up sorted with the leader last
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        void drainHeap(ItemType * const items, ssize_t const count,
+                ssize_t const drained) {
+            for (ssize_t next = count - 1; next >= count - drained; next--) {
+                ssize_t const leader = Layout::template leader<ItemType,
+                        compOp>(items, 0, next + 1);
+                std::swap(items[leader], items[next]);
+                siftDown<ItemType, compOp, Layout>(items, next, leader);
+            }
+        }
+    }
+
+    /*
+     * max-heap of trivially copyable items, top() is the item no other item
+     * is Below; pop() only moves the replacement one level down and leaves
+     * the rest of its sift-down pending, every later pop() advances all
+     * pending sift-downs by one level, oldest first, so the cache misses of
+     * several sift-downs overlap; push() settles them first
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Layout = QuaternaryHeapLayout>
+    class PriorityQueue {
+        ItemType * items;
+        ssize_t count;
+        ssize_t capacity;
+        ssize_t pending[privatePriorityQueue::QueueSize];
+        ssize_t pendingCount;
+
+        ssize_t rootLeader() const {
+            return Layout::template leader<ItemType, compOp>(items, 0, count);
+        }
+
+        void advancePending() {
+            pendingCount = privatePriorityQueue::advancePending<ItemType,
+                    compOp, Layout>(items, count, pending, pendingCount);
+        }
+
+        void settlePending() {
+            while (pendingCount > 0) {
+                advancePending();
+            }
+        }
+
+        void heapify() {
+            privatePriorityQueue::heapify<ItemType, compOp, Layout>(items,
+                    count);
+        }
+
+    public:
+
+        PriorityQueue() : items(nullptr), count(0), capacity(0),
+        pendingCount(0) {
+        }
+
+        ~PriorityQueue() {
+            free(items);
+        }
+
+        PriorityQueue(PriorityQueue const &) = delete;
+        PriorityQueue & operator=(PriorityQueue const &) = delete;
+
+        ssize_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void reserve(ssize_t const newCapacity) {
+            if (newCapacity <= capacity) {
+                return;
+            }
+            ItemType * const grown = allocateAligned<ItemType>(newCapacity);
+            if (count > 0) {
+                memcpy(grown, items, sizeof (ItemType) * count);
+            }
+            free(items);
+            items = grown;
+            capacity = newCapacity;
+        }
+
+        ItemType const & top() const {
+            assert(count > 0);
+            return items[rootLeader()];
+        }
+
+        void push(ItemType const item) {
+            settlePending();
+            if (count == capacity) {
+                reserve(std::max(capacity * 2,
+                        privatePriorityQueue::MinCapacity));
+            }
+            ssize_t current = count++;
+            items[current] = item;
+            while (current >= Layout::Arity) {
+                ssize_t const parent = Layout::parent(current);
+                if (!compOp(items[parent], Below, items[current])) {
+                    return;
+                }
+                std::swap(items[parent], items[current]);
+                current = parent;
+            }
+        }
+
+        void pop() {
+            assert(count > 0);
+            ssize_t const leader = rootLeader();
+            count--;
+            if (leader != count) {
+                items[leader] = items[count];
+                pending[pendingCount++] = leader;
+            }
+            advancePending();
+        }
+
+        /*
+         * batches smaller than a sixteenth of the queue are sifted up item by
+         * item, larger ones are appended and heapified bottom up, skipping
+         * the nodes that have no new item below them
+         */
+        void push(ItemType const * const source, ssize_t const sourceCount) {
+            settlePending();
+            if (count + sourceCount > capacity) {
+                reserve(std::max(count + sourceCount, capacity * 2));
+            }
+            if (sourceCount * privatePriorityQueue::BulkHeapifyFraction
+                    < count) {
+                for (ssize_t index = 0; index < sourceCount; index++) {
+                    push(source[index]);
+                }
+                return;
+            }
+            ssize_t const oldCount = count;
+            memcpy(items + count, source, sizeof (ItemType) * sourceCount);
+            count += sourceCount;
+            // parents have lower indices than their children in every
+            // layout, so a node is marked before the loop reaches it
+            std::vector<bool> affected(oldCount);
+            for (ssize_t node = count - 1; node >= 0; node--) {
+                if (node < oldCount && !affected[node]) {
+                    continue;
+                }
+                privatePriorityQueue::siftDown<ItemType, compOp, Layout>(
+                        items, count, node);
+                if (node >= Layout::Arity
+                        && Layout::parent(node) < oldCount) {
+                    affected[Layout::parent(node)] = true;
+                }
+            }
+        }
+
+        /*
+         * replaces the contents with the given items, heapified bottom up
+         */
+        void build(ItemType const * const source, ssize_t const sourceCount) {
+            pendingCount = 0;
+            count = 0;
+            reserve(sourceCount);
+            memcpy(items, source, sizeof (ItemType) * sourceCount);
+            count = sourceCount;
+            heapify();
+        }
+    };
+}
+
+#endif	/* PRIORITYQUEUE_HPP */
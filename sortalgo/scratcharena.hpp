@@ -0,0 +1,91 @@
+/* 
+ * scratcharena.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SCRATCHARENA_HPP
+#define	SCRATCHARENA_HPP
+
+#include "sortalgocommon.hpp"
+
+#include <cstdlib>
+
+namespace tarsa {
+
+    /*
+     * hands out scratchpads sized by the ScratchBytes queries of the
+     * algorithms, one at a time: every acquire() returns the same buffer,
+     * which only grows when a larger one is asked for, so repeated sorts
+     * allocate no scratchpad once the arena has seen the largest request,
+     * though the parallel sorts still allocate their bookkeeping; an arena
+     * can also start from memory it does not own, like huge pages
+     */
+    class ScratchArena {
+        int8_t * buffer;
+        ssize_t capacity;
+        bool owned;
+
+    public:
+
+        ScratchArena() : buffer(nullptr), capacity(0), owned(false) {
+        }
+
+        ScratchArena(int8_t * const buffer, ssize_t const capacity)
+        : buffer(buffer), capacity(capacity), owned(false) {
+        }
+
+        ~ScratchArena() {
+            if (owned) {
+                free(buffer);
+            }
+        }
+
+        ScratchArena(ScratchArena const &) = delete;
+        ScratchArena & operator=(ScratchArena const &) = delete;
+
+        ssize_t size() const {
+            return capacity;
+        }
+
+        /*
+         * the contents are not kept when the buffer grows
+         */
+        void reserve(ssize_t const bytes) {
+            if (bytes <= capacity) {
+                return;
+            }
+            int8_t * const grown = allocateAligned<int8_t>(bytes);
+            if (owned) {
+                free(buffer);
+            }
+            buffer = grown;
+            capacity = bytes;
+            owned = true;
+        }
+
+        int8_t * acquire(ssize_t const bytes) {
+            reserve(bytes);
+            return buffer;
+        }
+    };
+}
+
+#endif	/* SCRATCHARENA_HPP */
@@ -24,6 +24,10 @@
 #ifndef SORTALGOCOMMON_HPP
 #define	SORTALGOCOMMON_HPP
 
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
 namespace tarsa {
 
     template<int rw = 0, int locality = 3>
@@ -31,6 +35,21 @@ namespace tarsa {
         __builtin_prefetch(address, rw, locality);
     }
 
+    ssize_t constexpr CacheLineBytes = 64;
+
+    /*
+     * cache line aligned room for count items, released with free()
+     */
+    template<typename ItemType>
+    ItemType * allocateAligned(ssize_t const count) {
+        void * memory;
+        if (posix_memalign(&memory, CacheLineBytes, sizeof (ItemType) * count)
+                != 0) {
+            throw std::bad_alloc();
+        }
+        return (ItemType *) memory;
+    }
+
     enum ComparisonType {
         Below, Equal, Above
     };
@@ -55,6 +74,21 @@ namespace tarsa {
         return genericComparisonOperator(rightOp, opType, leftOp);
     }
 
+    /*
+     * scratchpads for keys with payloads hold the keys first, rounded up
+     * to a multiple of 64 bytes, then the payloads
+     */
+    template<typename KeyType>
+    ssize_t payloadScratchOffset(ssize_t const count) {
+        return (count * sizeof (KeyType) + 63) & ~63;
+    }
+
+    template<typename KeyType, typename PayloadType>
+    ssize_t keysAndPayloadsScratchBytes(ssize_t const count) {
+        return payloadScratchOffset<KeyType>(count)
+                + count * sizeof (PayloadType);
+    }
+
     namespace privateClusteredHeapsorts {
 
         ssize_t constexpr integerPower(ssize_t const base,
@@ -83,6 +117,77 @@ namespace tarsa {
         }
     }
 
+    namespace privateRadixSorts {
+
+        template<typename ItemType>
+        struct KeyTraits {
+        };
+
+        template<>
+        struct KeyTraits<uint32_t> {
+            typedef uint32_t RadixType;
+
+            static RadixType radix(uint32_t const key) {
+                return key;
+            }
+        };
+
+        template<>
+        struct KeyTraits<int32_t> {
+            typedef uint32_t RadixType;
+
+            static RadixType radix(int32_t const key) {
+                return (RadixType) key ^ ((RadixType) 1 << 31);
+            }
+        };
+
+        template<>
+        struct KeyTraits<uint64_t> {
+            typedef uint64_t RadixType;
+
+            static RadixType radix(uint64_t const key) {
+                return key;
+            }
+        };
+
+        template<>
+        struct KeyTraits<int64_t> {
+            typedef uint64_t RadixType;
+
+            static RadixType radix(int64_t const key) {
+                return (RadixType) key ^ ((RadixType) 1 << 63);
+            }
+        };
+
+        template<>
+        struct KeyTraits<float> {
+            typedef uint32_t RadixType;
+
+            static RadixType radix(float const key) {
+                RadixType bits;
+                memcpy(&bits, &key, sizeof (bits));
+                return bits ^ (-(bits >> 31) | ((RadixType) 1 << 31));
+            }
+        };
+
+        template<>
+        struct KeyTraits<double> {
+            typedef uint64_t RadixType;
+
+            static RadixType radix(double const key) {
+                RadixType bits;
+                memcpy(&bits, &key, sizeof (bits));
+                return bits ^ (-(bits >> 63) | ((RadixType) 1 << 63));
+            }
+        };
+
+        template<typename ItemType, bool Ascending>
+        typename KeyTraits<ItemType>::RadixType radix(ItemType const key) {
+            return Ascending ? KeyTraits<ItemType>::radix(key)
+                    : ~KeyTraits<ItemType>::radix(key);
+        }
+    }
+
     namespace compileTimeConstArrays {
         template<class T> using Invoke = typename T::type;
 
@@ -432,6 +432,15 @@ namespace tarsa {
         }
     }
 
+    /*
+     * one byte of cached comparisons per cluster
+     */
+    template<typename ItemType>
+    ssize_t CachedComparisonsBinaryHeapSortScratchBytes(ssize_t const count) {
+        using privateCachedComparisonsBinaryHeapSort::ClusterSize;
+        return (count + ClusterSize - 1) / ClusterSize;
+    }
+
     template<typename ItemType, ComparisonOperator<ItemType> compOp>
     void CachedComparisonsBinaryHeapSort(ItemType * const a,
             ssize_t const count, int8_t * const scratchpad) {
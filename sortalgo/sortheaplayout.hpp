@@ -0,0 +1,101 @@
+/* 
+ * sortheaplayout.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTHEAPLAYOUT_HPP
+#define	SORTHEAPLAYOUT_HPP
+
+#include "priorityqueue.hpp"
+#include "sortalgocommon.hpp"
+
+namespace tarsa {
+
+    /*
+     * heap sorts over any layout policy of priorityqueue.hpp, so new
+     * layouts can be tried with both kinds of drain without new kernels
+     */
+    namespace privateLayoutHeapSort {
+
+        using privatePriorityQueue::QueueSize;
+        using privatePriorityQueue::advancePending;
+        using privatePriorityQueue::drainHeap;
+        using privatePriorityQueue::heapify;
+
+        /*
+         * every replacement moves one level down per extraction, together
+         * with the earlier unfinished ones, like PriorityQueue::pop()
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout>
+        void drainHeapCascading(ItemType * const a, ssize_t const count) {
+            ssize_t pending[QueueSize];
+            ssize_t pendingCount = 0;
+            for (ssize_t next = count - 1; next > 0; next--) {
+                ssize_t const leader = Layout::template leader<ItemType,
+                        compOp>(a, 0, next + 1);
+                std::swap(a[leader], a[next]);
+                if (leader != next) {
+                    pending[pendingCount++] = leader;
+                }
+                pendingCount = advancePending<ItemType, compOp, Layout>(a,
+                        next, pending, pendingCount);
+            }
+        }
+    }
+
+    /*
+     * a has to be aligned to Layout::ArrayAlignment
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Layout>
+    void LayoutHeapSort(ItemType * const a, ssize_t const count) {
+        assert((uintptr_t) a % Layout::ArrayAlignment == 0);
+        privateLayoutHeapSort::heapify<ItemType, compOp, Layout>(a, count);
+        privateLayoutHeapSort::drainHeap<ItemType, compOp, Layout>(a, count,
+                count);
+    }
+
+    template<typename ItemType, typename Layout>
+    void LayoutHeapSort(ItemType * const a, ssize_t const count) {
+        LayoutHeapSort<ItemType, genericComparisonOperator, Layout>(a, count);
+    }
+
+    /*
+     * a has to be aligned to Layout::ArrayAlignment
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Layout>
+    void LayoutCascadingHeapSort(ItemType * const a, ssize_t const count) {
+        assert((uintptr_t) a % Layout::ArrayAlignment == 0);
+        privateLayoutHeapSort::heapify<ItemType, compOp, Layout>(a, count);
+        privateLayoutHeapSort::drainHeapCascading<ItemType, compOp, Layout>(
+                a, count);
+    }
+
+    template<typename ItemType, typename Layout>
+    void LayoutCascadingHeapSort(ItemType * const a, ssize_t const count) {
+        LayoutCascadingHeapSort<ItemType, genericComparisonOperator, Layout>(
+                a, count);
+    }
+}
+
+#endif	/* SORTHEAPLAYOUT_HPP */
@@ -0,0 +1,211 @@
+/* 
+ * sortheapmulti.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTHEAPMULTI_HPP
+#define	SORTHEAPMULTI_HPP
+
+#include "kwaymerge.hpp"
+#include "sortalgocommon.hpp"
+#include "sortheaphybridcascading.hpp"
+#include "workstealingpool.hpp"
+
+#include <vector>
+
+namespace tarsa {
+
+    namespace privateMultiHeapSort {
+
+        ssize_t constexpr MinChunkSize = 1 << 14;
+
+        /*
+         * bounds[part * runs + run] is where the part starts in the run
+         */
+        struct RunPartition {
+            ssize_t runs;
+            ssize_t parts;
+            std::vector<ssize_t> bounds;
+            std::vector<ssize_t> targetStarts;
+        };
+
+        /*
+         * equal keys are ordered by run and by position, so splitters are
+         * unique even if the keys are not
+         */
+        template<typename ItemType>
+        struct Sample {
+            ItemType key;
+            ssize_t run;
+            ssize_t position;
+        };
+
+        /*
+         * regular sampling splits every run at the same splitters, so the
+         * merged parts are independent and, with ties broken by run and
+         * position, none exceeds twice its share even for repeated keys
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        RunPartition partitionRuns(ItemType const * const a,
+                std::vector<ssize_t> const &runStarts, ssize_t const parts) {
+            ssize_t const runsCount = runStarts.size() - 1;
+            std::vector<Sample<ItemType> > samples;
+            for (ssize_t run = 0; run < runsCount; run++) {
+                ssize_t const length = runStarts[run + 1] - runStarts[run];
+                for (ssize_t sample = 1; sample < parts; sample++) {
+                    ssize_t const position = runStarts[run]
+                            + length * sample / parts;
+                    if (position < runStarts[run + 1]) {
+                        samples.push_back({a[position], run, position});
+                    }
+                }
+            }
+            std::sort(samples.begin(), samples.end(),
+                    [](Sample<ItemType> const &left,
+                    Sample<ItemType> const &right) {
+                        if (compOp(left.key, Below, right.key)
+                                || compOp(right.key, Below, left.key)) {
+                            return compOp(left.key, Below, right.key);
+                        }
+                        return left.run < right.run || (left.run == right.run
+                                && left.position < right.position);
+                    });
+            auto const below = [](ItemType const &left,
+                    ItemType const &right) {
+                return compOp(left, Below, right);
+            };
+
+            RunPartition partition = {runsCount, parts,
+                std::vector<ssize_t>((parts + 1) * runsCount),
+                std::vector<ssize_t>(parts + 1)};
+            for (ssize_t part = 0; part <= parts; part++) {
+                for (ssize_t run = 0; run < runsCount; run++) {
+                    ssize_t bound;
+                    if (part == 0) {
+                        bound = runStarts[run];
+                    } else if (part == parts || samples.empty()) {
+                        bound = runStarts[run + 1];
+                    } else {
+                        Sample<ItemType> const &splitter = samples[part
+                                * samples.size() / parts];
+                        // the items before the splitter in (key, run,
+                        // position) order
+                        if (run < splitter.run) {
+                            bound = std::upper_bound(a + runStarts[run],
+                                    a + runStarts[run + 1], splitter.key,
+                                    below) - a;
+                        } else if (run > splitter.run) {
+                            bound = std::lower_bound(a + runStarts[run],
+                                    a + runStarts[run + 1], splitter.key,
+                                    below) - a;
+                        } else {
+                            bound = splitter.position;
+                        }
+                    }
+                    partition.bounds[part * runsCount + run] = bound;
+                    partition.targetStarts[part] += bound - runStarts[run];
+                }
+            }
+            return partition;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void mergePart(ItemType const * const a,
+                RunPartition const &partition, ssize_t const part,
+                ItemType * const target) {
+            ssize_t const runsCount = partition.runs;
+            std::vector<MergeRun<ItemType> > runs(runsCount);
+            for (ssize_t run = 0; run < runsCount; run++) {
+                runs[run].begin = a + partition.bounds[part * runsCount + run];
+                runs[run].end = a + partition.bounds[(part + 1) * runsCount
+                        + run];
+            }
+            KWayMerge<ItemType, compOp>(runs.data(), runsCount,
+                    target + partition.targetStarts[part]);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void mergeRuns(WorkStealingPool &pool, ItemType const * const a,
+                std::vector<ssize_t> const &runStarts,
+                ItemType * const target) {
+            RunPartition const partition = partitionRuns<ItemType, compOp>(a,
+                    runStarts, runStarts.size() - 1);
+            pool.parallelFor(0, partition.parts, 1, [&](ssize_t const first,
+                    ssize_t const last) {
+                for (ssize_t part = first; part < last; part++) {
+                    mergePart<ItemType, compOp>(a, partition, part, target);
+                }
+            });
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t MultiHeapSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * count;
+    }
+
+    /*
+     * every worker heap sorts its own chunk, then the sorted chunks are
+     * merged through the scratchpad, which has to hold count items; has to
+     * be called from inside pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    void (*heapSort)(ItemType *, ssize_t)>
+    void MultiHeapSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        ssize_t const chunks = std::max((ssize_t) 1, std::min(pool.size(),
+                count / privateMultiHeapSort::MinChunkSize));
+        if (chunks == 1) {
+            heapSort(a, count);
+            return;
+        }
+        std::vector<ssize_t> chunkStarts(chunks + 1);
+        for (ssize_t chunk = 0; chunk <= chunks; chunk++) {
+            chunkStarts[chunk] = count * chunk / chunks;
+        }
+        pool.parallelFor(0, chunks, 1, [&](ssize_t const first,
+                ssize_t const last) {
+            for (ssize_t chunk = first; chunk < last; chunk++) {
+                heapSort(a + chunkStarts[chunk],
+                        chunkStarts[chunk + 1] - chunkStarts[chunk]);
+            }
+        });
+
+        ItemType * const merged = (ItemType *) scratchpad;
+        privateMultiHeapSort::mergeRuns<ItemType, compOp>(pool, a, chunkStarts,
+                merged);
+        pool.parallelFor(0, chunks, 1, [&](ssize_t const first,
+                ssize_t const last) {
+            std::copy(merged + chunkStarts[first], merged + chunkStarts[last],
+                    a + chunkStarts[first]);
+        });
+    }
+
+    template<typename ItemType>
+    void MultiHeapSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        MultiHeapSort<ItemType, genericComparisonOperator,
+                HybridCascadingHeapSort<ItemType, genericComparisonOperator> >(
+                pool, a, count, scratchpad);
+    }
+}
+
+#endif	/* SORTHEAPMULTI_HPP */
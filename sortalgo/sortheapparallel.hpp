@@ -0,0 +1,289 @@
+/* 
+ * sortheapparallel.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTHEAPPARALLEL_HPP
+#define	SORTHEAPPARALLEL_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheapbinaryclusteredvariantb.hpp"
+#include "sortheaphybridcascading.hpp"
+#include "sortheapternaryclusteredvariantb.hpp"
+#include "workstealingpool.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace tarsa {
+
+    /*
+     * clusters are stored level by level, so all clusters at a given depth
+     * form a contiguous range and their subtrees are disjoint; the ranges
+     * are heapified from the deepest one up, each of them in parallel
+     */
+    namespace privateParallelHeapify {
+
+        ssize_t constexpr TasksPerWorker = 8;
+
+        typedef std::pair<ssize_t, ssize_t> ClusterRange;
+
+        void forEachDepthBottomUp(WorkStealingPool &pool,
+                std::vector<ClusterRange> const &depths,
+                std::function<void(ssize_t, ssize_t) > const &heapifyRange) {
+            for (ssize_t depth = depths.size() - 1; depth >= 0; depth--) {
+                ssize_t const begin = depths[depth].first;
+                ssize_t const end = depths[depth].second;
+                ssize_t const grain = std::max((ssize_t) 1, (end - begin)
+                        / (pool.size() * TasksPerWorker));
+                pool.parallelFor(begin, end, grain, heapifyRange);
+            }
+        }
+
+        /*
+         * firstDepthWidth is the number of clusters hanging directly below
+         * the top part, every cluster has clusterArity child clusters
+         */
+        std::vector<ClusterRange> clusterDepths(ssize_t const clusters,
+                ssize_t const firstDepthWidth, ssize_t const clusterArity) {
+            std::vector<ClusterRange> depths;
+            ssize_t width = firstDepthWidth;
+            for (ssize_t begin = 0; begin < clusters; ) {
+                ssize_t const end = std::min(begin + width, clusters);
+                depths.push_back(ClusterRange(begin, end));
+                begin = end;
+                width *= clusterArity;
+            }
+            return depths;
+        }
+
+        template<typename ItemType, ssize_t arity, ssize_t clusterLevels,
+        void (*siftDownInit)(ItemType *, ssize_t, ssize_t, ssize_t, ssize_t),
+        void (*siftDownLast)(ItemType *, ssize_t, ssize_t, ssize_t, ssize_t)>
+        void heapifyClustered(WorkStealingPool &pool, ItemType * const a,
+                ssize_t const count) {
+            using namespace privateClusteredHeapsorts;
+            ssize_t constexpr clusterSize =
+                    computeClusterSize < clusterLevels + 1 > (arity) - 1;
+            ssize_t constexpr clusterArity =
+                    computeClusterLevelSize<clusterLevels>(arity);
+            ssize_t constexpr relativeLastLevelStart =
+                    computeClusterSize<clusterLevels>(arity) - 1;
+
+            ssize_t const clusters = (count + clusterSize - 1) / clusterSize;
+            forEachDepthBottomUp(pool, clusterDepths(clusters, 1, clusterArity),
+                    [&](ssize_t const begin, ssize_t const end) {
+                        for (ssize_t cluster = end - 1; cluster >= begin;
+                                cluster--) {
+                            ssize_t const clusterStart = cluster * clusterSize;
+                            for (ssize_t item = std::min(clusterStart
+                                    + clusterSize, count) - 1;
+                                    item >= clusterStart; item--) {
+                                ssize_t const relative = item - clusterStart;
+                                if (relative >= relativeLastLevelStart) {
+                                    siftDownLast(a, item, clusterStart
+                                            * clusterArity + (relative
+                                            - relativeLastLevelStart + 1)
+                                            * clusterSize, count,
+                                            clusterStart);
+                                } else {
+                                    siftDownInit(a, item, (relative + 1)
+                                            * arity, count, clusterStart);
+                                }
+                            }
+                        }
+                    });
+        }
+
+        namespace hybridCascading {
+
+            using namespace privateCascadingHybridHeapSort;
+
+            ssize_t childClusterStart(ssize_t const parent,
+                    ssize_t const clusterStart) {
+                return (parent - clusterStart - SmallClusterSecondLevelStart
+                        + 1) * SmallClusterSize + (clusterStart - 1)
+                        * SmallClusterTotalArity - TopClusterLastLevelStart
+                        + 1;
+            }
+
+            /*
+             * moves the item at parent one level down, among the given
+             * children, returns false when it stays in place
+             */
+            template<typename ItemType, ComparisonOperator<ItemType> compOp>
+            bool siftDownStep(ItemType * const a, ssize_t const count,
+                    ssize_t * const parent, ssize_t const firstChild,
+                    ssize_t const children) {
+                ssize_t leader = *parent;
+                for (ssize_t child = firstChild; child < std::min(count,
+                        firstChild + children); child++) {
+                    if (compOp(a[leader], Below, a[child])) {
+                        leader = child;
+                    }
+                }
+                if (leader == *parent) {
+                    return false;
+                }
+                std::swap(a[leader], a[*parent]);
+                *parent = leader;
+                return true;
+            }
+
+            template<typename ItemType, ComparisonOperator<ItemType> compOp>
+            void siftDownFromSecondLevel(ItemType * const a,
+                    ssize_t const count, ssize_t parent,
+                    ssize_t const clusterStart) {
+                ssize_t cluster = childClusterStart(parent, clusterStart);
+                while (!siftDownSingleStep<ItemType, compOp>(a, count,
+                        &parent, &cluster)) {
+                }
+            }
+
+            template<typename ItemType, ComparisonOperator<ItemType> compOp>
+            void heapifyClusters(ItemType * const a, ssize_t const count,
+                    ssize_t const begin, ssize_t const end) {
+                for (ssize_t cluster = end - 1; cluster >= begin; cluster--) {
+                    ssize_t const clusterStart = TopClusterSize
+                            + cluster * SmallClusterSize;
+                    for (ssize_t item = std::min(clusterStart
+                            + SmallClusterSize, count) - 1;
+                            item >= clusterStart; item--) {
+                        ssize_t parent = item;
+                        if (item - clusterStart
+                                >= SmallClusterSecondLevelStart) {
+                            siftDownFromSecondLevel<ItemType, compOp>(a,
+                                    count, parent, clusterStart);
+                        } else if (siftDownStep<ItemType, compOp>(a, count,
+                                &parent, clusterStart
+                                + SmallClusterSecondLevelStart
+                                + (item - clusterStart)
+                                * SmallClusterArities[0],
+                                SmallClusterArities[0])) {
+                            siftDownFromSecondLevel<ItemType, compOp>(a,
+                                    count, parent, clusterStart);
+                        }
+                    }
+                }
+            }
+
+            template<typename ItemType, ComparisonOperator<ItemType> compOp>
+            void heapifyTop(ItemType * const a, ssize_t const count) {
+                for (ssize_t item = std::min(TopClusterSize, count) - 1;
+                        item >= 0; item--) {
+                    ssize_t parent = item;
+                    while (parent < TopClusterLastLevelStart
+                            && siftDownStep<ItemType, compOp>(a, count,
+                            &parent, parent * TopClusterStepArity + 1,
+                            TopClusterStepArity)) {
+                    }
+                    if (parent >= TopClusterLastLevelStart) {
+                        ssize_t cluster = (parent - TopClusterLastLevelStart)
+                                * SmallClusterSize + TopClusterSize;
+                        while (!siftDownSingleStep<ItemType, compOp>(a, count,
+                                &parent, &cluster)) {
+                        }
+                    }
+                }
+            }
+
+            template<typename ItemType, ComparisonOperator<ItemType> compOp>
+            void heapify(WorkStealingPool &pool, ItemType * const a,
+                    ssize_t const count) {
+                ssize_t const clusters = std::max((ssize_t) 0,
+                        (count - TopClusterSize + SmallClusterSize - 1)
+                        / SmallClusterSize);
+                forEachDepthBottomUp(pool, clusterDepths(clusters,
+                        TopClusterTotalArity, SmallClusterTotalArity),
+                        [&](ssize_t const begin, ssize_t const end) {
+                            heapifyClusters<ItemType, compOp>(a, count, begin,
+                                    end);
+                        });
+                heapifyTop<ItemType, compOp>(a, count);
+            }
+        }
+    }
+
+    /*
+     * has to be called from inside pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    ssize_t clusterLevels = 5 >
+    void ParallelClusteredBinaryHeapSortVariantB(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        using namespace privateClusteredBinaryHeapSortVariantB;
+        privateParallelHeapify::heapifyClustered<ItemType, arity, clusterLevels,
+                siftDownInit<ItemType, compOp, clusterLevels>,
+                siftDownLast<ItemType, compOp, clusterLevels> >(
+                pool, a, count);
+        drainHeap<ItemType, compOp, clusterLevels>(a, count);
+    }
+
+    template<typename ItemType>
+    void ParallelClusteredBinaryHeapSortVariantB(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        ParallelClusteredBinaryHeapSortVariantB<ItemType,
+                genericComparisonOperator>(pool, a, count);
+    }
+
+    /*
+     * has to be called from inside pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    ssize_t clusterLevels = 3 >
+    void ParallelClusteredTernaryHeapSortVariantB(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        using namespace privateClusteredTernaryHeapSortVariantB;
+        privateParallelHeapify::heapifyClustered<ItemType, arity, clusterLevels,
+                siftDownInit<ItemType, compOp, clusterLevels>,
+                siftDownLast<ItemType, compOp, clusterLevels> >(
+                pool, a, count);
+        drainHeap<ItemType, compOp, clusterLevels>(a, count);
+    }
+
+    template<typename ItemType>
+    void ParallelClusteredTernaryHeapSortVariantB(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        ParallelClusteredTernaryHeapSortVariantB<ItemType,
+                genericComparisonOperator>(pool, a, count);
+    }
+
+    /*
+     * has to be called from inside pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void ParallelHybridCascadingHeapSort(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        privateParallelHeapify::hybridCascading::heapify<ItemType, compOp>(
+                pool, a, count);
+        privateCascadingHybridHeapSort::drainHeap<ItemType, compOp>(a, count);
+    }
+
+    template<typename ItemType>
+    void ParallelHybridCascadingHeapSort(WorkStealingPool &pool,
+            ItemType * const a, ssize_t const count) {
+        ParallelHybridCascadingHeapSort<ItemType, genericComparisonOperator>(
+                pool, a, count);
+    }
+}
+
+#endif	/* SORTHEAPPARALLEL_HPP */
@@ -0,0 +1,210 @@
+/* 
+ * sortincremental.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTINCREMENTAL_HPP
+#define	SORTINCREMENTAL_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheaphybridcascading.hpp"
+#include "sortselect.hpp"
+
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace tarsa {
+
+    namespace privateIncrementalSort {
+
+        ssize_t constexpr NintherThreshold = 128;
+        ssize_t constexpr UnbalancedFraction = 16;
+
+        /*
+         * the end of a segment and the unbalanced partitions still allowed
+         * on the way to it
+         */
+        struct Bound {
+            ssize_t end;
+            ssize_t badPartitionsLeft;
+        };
+    }
+
+    /*
+     * based on: "Optimal Incremental Sorting" by Paredes and Navarro;
+     * sorts the array in place, but only as far as it is read: a stack of
+     * pivot positions, each with nothing Above it before and nothing Below
+     * it after, shrinks the segment holding the next item, so reading the
+     * first k items costs O(n + k log k) expected; a segment that took
+     * too many unbalanced partitions to reach is heap sorted
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Partitioner = privateSelect::ScalarPartitioner<ItemType, compOp> >
+    class IncrementalSort {
+        ItemType * const a;
+        ssize_t const count;
+        ssize_t sortedEnd;
+        std::vector<privateIncrementalSort::Bound> bounds;
+
+        ItemType selectPivot(ssize_t const left, ssize_t const right) const {
+            using privateSelect::medianOf3;
+            ssize_t const middle = left + (right - left) / 2;
+            if (right - left < privateIncrementalSort::NintherThreshold) {
+                return medianOf3<ItemType, compOp>(a[left], a[middle],
+                        a[right - 1]);
+            }
+            ssize_t const step = (right - left) / 8;
+            return medianOf3<ItemType, compOp>(
+                    medianOf3<ItemType, compOp>(a[left], a[left + step],
+                    a[left + step * 2]),
+                    medianOf3<ItemType, compOp>(a[middle - step], a[middle],
+                    a[middle + step]),
+                    medianOf3<ItemType, compOp>(a[right - 1 - step * 2],
+                    a[right - 1 - step], a[right - 1]));
+        }
+
+        /*
+         * extends the sorted prefix past the given position
+         */
+        void settle(ssize_t const position) {
+            while (sortedEnd <= position) {
+                ssize_t const left = sortedEnd;
+                ssize_t const right = bounds.back().end;
+                ssize_t badPartitionsLeft = bounds.back().badPartitionsLeft;
+                if (right - left <= Partitioner::SmallThreshold
+                        || badPartitionsLeft == 0) {
+                    if (right - left <= Partitioner::SmallThreshold) {
+                        Partitioner::sortSmall(a + left, right - left);
+                    } else {
+                        HybridCascadingHeapSort<ItemType, compOp>(a + left,
+                                right - left);
+                    }
+                    sortedEnd = right;
+                    bounds.pop_back();
+                    continue;
+                }
+                ItemType const pivot = selectPivot(left, right);
+                ssize_t const middle = Partitioner::template partition<false>(
+                        a, left, right, pivot);
+                ssize_t const smaller = std::min(middle - left, right - middle);
+                if (smaller < (right - left)
+                        / privateIncrementalSort::UnbalancedFraction) {
+                    badPartitionsLeft--;
+                }
+                // both sides were reached through this partition
+                bounds.back().badPartitionsLeft = badPartitionsLeft;
+                if (middle > left) {
+                    bounds.push_back({middle, badPartitionsLeft});
+                } else {
+                    // nothing is Below the pivot, so its copies come first
+                    sortedEnd = Partitioner::template partition<true>(a,
+                            left, right, pivot);
+                    if (sortedEnd == right) {
+                        bounds.pop_back();
+                    }
+                }
+            }
+        }
+
+    public:
+
+        class iterator : public std::iterator<std::input_iterator_tag,
+        ItemType> {
+            IncrementalSort * sort;
+            ssize_t index;
+
+        public:
+
+            iterator(IncrementalSort * const sort, ssize_t const index)
+            : sort(sort), index(index) {
+            }
+
+            ItemType const & operator*() const {
+                return (*sort)[index];
+            }
+
+            iterator & operator++() {
+                index++;
+                return *this;
+            }
+
+            bool operator==(iterator const &other) const {
+                return index == other.index;
+            }
+
+            bool operator!=(iterator const &other) const {
+                return index != other.index;
+            }
+        };
+
+        IncrementalSort(ItemType * const a, ssize_t const count)
+        : a(a), count(count), sortedEnd(0) {
+            ssize_t badPartitionsLeft = 0;
+            for (ssize_t remaining = count; remaining > 1; remaining >>= 1) {
+                badPartitionsLeft += 2;
+            }
+            bounds.push_back({count, badPartitionsLeft});
+        }
+
+        ssize_t size() const {
+            return count;
+        }
+
+        /*
+         * positions below this one are already in their final place
+         */
+        ssize_t sortedCount() const {
+            return sortedEnd;
+        }
+
+        /*
+         * sorts every position up to index, cost grows with index only
+         */
+        ItemType const & operator[](ssize_t const index) {
+            assert(index >= 0 && index < count);
+            settle(index);
+            return a[index];
+        }
+
+        iterator begin() {
+            return iterator(this, 0);
+        }
+
+        iterator end() {
+            return iterator(this, count);
+        }
+    };
+
+    /*
+     * dword items are partitioned with AVX2
+     */
+    template<typename ItemType>
+    using DefaultIncrementalSort = IncrementalSort<ItemType,
+            genericComparisonOperator, typename std::conditional<
+            std::is_same<ItemType, int32_t>::value
+            || std::is_same<ItemType, uint32_t>::value,
+            privateSelect::SimdDwordPartitioner<ItemType, true>,
+            privateSelect::ScalarPartitioner<ItemType,
+            genericComparisonOperator> >::type>;
+}
+
+#endif	/* SORTINCREMENTAL_HPP */
@@ -0,0 +1,128 @@
+/* 
+ * sortmergenuma.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTMERGENUMA_HPP
+#define	SORTMERGENUMA_HPP
+
+#include "numatopology.hpp"
+#include "sortalgocommon.hpp"
+#include "sortheapmulti.hpp"
+#include "sortquickpatterndefeating.hpp"
+#include "workstealingpool.hpp"
+
+#include <vector>
+
+namespace tarsa {
+
+    namespace privateNumaMergeSort {
+
+        ssize_t constexpr MinChunkSize = 1 << 14;
+
+        std::vector<ssize_t> chunkStarts(ssize_t const count,
+                ssize_t const chunks) {
+            std::vector<ssize_t> starts(chunks + 1);
+            for (ssize_t chunk = 0; chunk <= chunks; chunk++) {
+                starts[chunk] = count * chunk / chunks;
+            }
+            return starts;
+        }
+    }
+
+    /*
+     * binds chunk w of the buffer to the node of worker w and lets worker w
+     * touch it first, matching the chunks NumaMergeSort works on; returns
+     * false when the kernel refused the binding, then only the first touch
+     * places the pages; has to be called from inside pool.run()
+     */
+    template<typename ItemType>
+    bool NumaPlaceForWorkers(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count) {
+        std::vector<ssize_t> const starts =
+                privateNumaMergeSort::chunkStarts(count, pool.size());
+        bool bound = true;
+        for (ssize_t worker = 0; worker < pool.size(); worker++) {
+            bound &= bindToNode(a + starts[worker], (starts[worker + 1]
+                    - starts[worker]) * sizeof (ItemType),
+                    pool.workerNode(worker));
+        }
+        pool.onEachWorker([&](ssize_t const worker) {
+            std::fill((int8_t *) (a + starts[worker]),
+                    (int8_t *) (a + starts[worker + 1]), 0);
+        });
+        return bound;
+    }
+
+    template<typename ItemType>
+    ssize_t NumaMergeSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * count;
+    }
+
+    /*
+     * every worker sorts the chunk placed on its node, then merges one part
+     * of the output into the scratchpad at the part's own offsets, which
+     * only roughly follow the chunks, so merge reads and the part edges
+     * cross nodes; finally every worker copies its own chunk back, local
+     * on both sides; the scratchpad has to hold count items and both
+     * buffers should be placed with NumaPlaceForWorkers; needs a pinned
+     * pool for the locality to hold, has to be called from inside pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    void (*sequentialSort)(ItemType *, ssize_t)>
+    void NumaMergeSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        if (pool.size() == 1
+                || count < pool.size() * privateNumaMergeSort::MinChunkSize) {
+            sequentialSort(a, count);
+            return;
+        }
+        std::vector<ssize_t> const starts =
+                privateNumaMergeSort::chunkStarts(count, pool.size());
+        pool.onEachWorker([&](ssize_t const worker) {
+            sequentialSort(a + starts[worker],
+                    starts[worker + 1] - starts[worker]);
+        });
+
+        ItemType * const merged = (ItemType *) scratchpad;
+        privateMultiHeapSort::RunPartition const partition =
+                privateMultiHeapSort::partitionRuns<ItemType, compOp>(a,
+                starts, pool.size());
+        pool.onEachWorker([&](ssize_t const worker) {
+            privateMultiHeapSort::mergePart<ItemType, compOp>(a, partition,
+                    worker, merged);
+        });
+        pool.onEachWorker([&](ssize_t const worker) {
+            std::copy(merged + starts[worker], merged + starts[worker + 1],
+                    a + starts[worker]);
+        });
+    }
+
+    template<typename ItemType>
+    void NumaMergeSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        NumaMergeSort<ItemType, genericComparisonOperator,
+                PatternDefeatingQuickSort<ItemType,
+                genericComparisonOperator> >(pool, a, count, scratchpad);
+    }
+}
+
+#endif	/* SORTMERGENUMA_HPP */
@@ -0,0 +1,359 @@
+/* 
+ * sortmergepower.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTMERGEPOWER_HPP
+#define	SORTMERGEPOWER_HPP
+
+#include "sortalgocommon.hpp"
+
+namespace tarsa {
+
+    /*
+     * natural merge sort with the merge policy from: "Nearly-Optimal
+     * Mergesorts: Fast, Practical Sorting Methods That Optimally Adapt to
+     * Existing Runs" and galloping merges borrowed from TimSort
+     */
+    namespace privatePowerSort {
+
+        ssize_t constexpr MinRunLength = 24;
+        ssize_t constexpr MinGallop = 7;
+        ssize_t constexpr MaxStackDepth = 64;
+
+        struct Run {
+            ssize_t begin;
+            ssize_t power;
+        };
+
+        /*
+         * number of leading items that are below key (Strict) or not above
+         * key (not Strict), found by exponential and then binary search
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        bool Strict>
+        ssize_t gallopForward(ItemType const key, ItemType const * const a,
+                ssize_t const count) {
+            auto precedes = [&](ItemType const &item) {
+                return Strict ? compOp(item, Below, key)
+                        : !compOp(key, Below, item);
+            };
+            ssize_t found = 0;
+            ssize_t step = 1;
+            while (found + step <= count && precedes(a[found + step - 1])) {
+                found += step;
+                step *= 2;
+            }
+            ssize_t high = std::min(found + step - 1, count);
+            while (found < high) {
+                ssize_t const middle = found + (high - found) / 2;
+                if (precedes(a[middle])) {
+                    found = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return found;
+        }
+
+        /*
+         * number of trailing items that are above key (Strict) or not below
+         * key (not Strict)
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        bool Strict>
+        ssize_t gallopBackward(ItemType const key, ItemType const * const a,
+                ssize_t const count) {
+            auto follows = [&](ItemType const &item) {
+                return Strict ? compOp(key, Below, item)
+                        : !compOp(item, Below, key);
+            };
+            ssize_t found = 0;
+            ssize_t step = 1;
+            while (found + step <= count
+                    && follows(a[count - found - step])) {
+                found += step;
+                step *= 2;
+            }
+            ssize_t high = std::min(found + step - 1, count);
+            while (found < high) {
+                ssize_t const middle = found + (high - found) / 2;
+                if (follows(a[count - 1 - middle])) {
+                    found = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return found;
+        }
+
+        /*
+         * left run is moved to the buffer and merged from the front
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void mergeLow(ItemType * const a, ssize_t const begin,
+                ssize_t const middle, ssize_t const end,
+                ItemType * const buffer) {
+            ssize_t const leftCount = middle - begin;
+            std::copy(a + begin, a + middle, buffer);
+            ssize_t left = 0;
+            ssize_t right = middle;
+            ssize_t target = begin;
+            while (left < leftCount && right < end) {
+                ssize_t leftWins = 0;
+                ssize_t rightWins = 0;
+                do {
+                    if (compOp(a[right], Below, buffer[left])) {
+                        a[target++] = a[right++];
+                        rightWins++;
+                        leftWins = 0;
+                    } else {
+                        a[target++] = buffer[left++];
+                        leftWins++;
+                        rightWins = 0;
+                    }
+                } while (left < leftCount && right < end
+                        && leftWins < MinGallop && rightWins < MinGallop);
+
+                while (left < leftCount && right < end) {
+                    ssize_t const leftRun = gallopForward<ItemType, compOp,
+                            false>(a[right], buffer + left, leftCount - left);
+                    std::copy(buffer + left, buffer + left + leftRun,
+                            a + target);
+                    left += leftRun;
+                    target += leftRun;
+                    if (left == leftCount) {
+                        break;
+                    }
+                    ssize_t const rightRun = gallopForward<ItemType, compOp,
+                            true>(buffer[left], a + right, end - right);
+                    std::copy(a + right, a + right + rightRun, a + target);
+                    right += rightRun;
+                    target += rightRun;
+                    if (leftRun < MinGallop && rightRun < MinGallop) {
+                        break;
+                    }
+                }
+            }
+            std::copy(buffer + left, buffer + leftCount, a + target);
+        }
+
+        /*
+         * right run is moved to the buffer and merged from the back
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void mergeHigh(ItemType * const a, ssize_t const begin,
+                ssize_t const middle, ssize_t const end,
+                ItemType * const buffer) {
+            std::copy(a + middle, a + end, buffer);
+            ssize_t left = middle;
+            ssize_t right = end - middle;
+            ssize_t target = end;
+            while (left > begin && right > 0) {
+                ssize_t leftWins = 0;
+                ssize_t rightWins = 0;
+                do {
+                    if (compOp(buffer[right - 1], Below, a[left - 1])) {
+                        a[--target] = a[--left];
+                        leftWins++;
+                        rightWins = 0;
+                    } else {
+                        a[--target] = buffer[--right];
+                        rightWins++;
+                        leftWins = 0;
+                    }
+                } while (left > begin && right > 0
+                        && leftWins < MinGallop && rightWins < MinGallop);
+
+                while (left > begin && right > 0) {
+                    ssize_t const leftRun = gallopBackward<ItemType, compOp,
+                            true>(buffer[right - 1], a + begin, left - begin);
+                    std::copy_backward(a + left - leftRun, a + left,
+                            a + target);
+                    left -= leftRun;
+                    target -= leftRun;
+                    if (left == begin) {
+                        break;
+                    }
+                    ssize_t const rightRun = gallopBackward<ItemType, compOp,
+                            false>(a[left - 1], buffer, right);
+                    std::copy(buffer + right - rightRun, buffer + right,
+                            a + target - rightRun);
+                    right -= rightRun;
+                    target -= rightRun;
+                    if (leftRun < MinGallop && rightRun < MinGallop) {
+                        break;
+                    }
+                }
+            }
+            std::copy(buffer, buffer + right, a + target - right);
+        }
+
+        /*
+         * buffer has to hold the shorter of the two runs
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void merge(ItemType * const a, ssize_t begin, ssize_t const middle,
+                ssize_t end, ItemType * const buffer) {
+            begin += gallopForward<ItemType, compOp, false>(a[middle],
+                    a + begin, middle - begin);
+            if (begin == middle) {
+                return;
+            }
+            end -= gallopBackward<ItemType, compOp, false>(a[middle - 1],
+                    a + middle, end - middle);
+            if (middle - begin <= end - middle) {
+                mergeLow<ItemType, compOp>(a, begin, middle, end, buffer);
+            } else {
+                mergeHigh<ItemType, compOp>(a, begin, middle, end, buffer);
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void binaryInsertionSort(ItemType * const a, ssize_t const begin,
+                ssize_t sorted, ssize_t const end) {
+            for (; sorted < end; sorted++) {
+                ItemType const item = a[sorted];
+                ssize_t low = begin;
+                ssize_t high = sorted;
+                while (low < high) {
+                    ssize_t const middle = low + (high - low) / 2;
+                    if (compOp(item, Below, a[middle])) {
+                        high = middle;
+                    } else {
+                        low = middle + 1;
+                    }
+                }
+                std::copy_backward(a + low, a + sorted, a + sorted + 1);
+                a[low] = item;
+            }
+        }
+
+        /*
+         * strictly descending runs are reversed, short runs are extended
+         * with binary insertion sort
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        ssize_t extendRun(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            ssize_t runEnd = begin + 1;
+            if (runEnd == end) {
+                return end;
+            }
+            if (compOp(a[runEnd], Below, a[begin])) {
+                while (runEnd < end
+                        && compOp(a[runEnd], Below, a[runEnd - 1])) {
+                    runEnd++;
+                }
+                std::reverse(a + begin, a + runEnd);
+            } else {
+                while (runEnd < end
+                        && !compOp(a[runEnd], Below, a[runEnd - 1])) {
+                    runEnd++;
+                }
+            }
+            if (runEnd - begin < MinRunLength) {
+                ssize_t const limit = std::min(begin + MinRunLength, end);
+                binaryInsertionSort<ItemType, compOp>(a, begin, runEnd, limit);
+                runEnd = limit;
+            }
+            return runEnd;
+        }
+
+        /*
+         * depth of the node between two adjacent runs in the nearly optimal
+         * merge tree, computed from the binary expansions of run midpoints
+         */
+        ssize_t nodePower(ssize_t const begin, ssize_t const middle,
+                ssize_t const end, ssize_t const count) {
+            ssize_t a = begin + middle;
+            ssize_t b = middle + end;
+            ssize_t power = 0;
+            while (true) {
+                power++;
+                if (a >= count) {
+                    a -= count;
+                    b -= count;
+                } else if (b >= count) {
+                    break;
+                }
+                a *= 2;
+                b *= 2;
+            }
+            return power;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void powersort(ItemType * const a, ssize_t const count,
+                ItemType * const buffer) {
+            Run stack[MaxStackDepth];
+            ssize_t stackSize = 0;
+            ssize_t begin = 0;
+            ssize_t middle = extendRun<ItemType, compOp>(a, 0, count);
+            while (middle < count) {
+                ssize_t const end = extendRun<ItemType, compOp>(a, middle,
+                        count);
+                ssize_t const power = nodePower(begin, middle, end, count);
+                while (stackSize > 0 && stack[stackSize - 1].power > power) {
+                    stackSize--;
+                    merge<ItemType, compOp>(a, stack[stackSize].begin, begin,
+                            middle, buffer);
+                    begin = stack[stackSize].begin;
+                }
+                assert(stackSize < MaxStackDepth);
+                stack[stackSize++] = {begin, power};
+                begin = middle;
+                middle = end;
+            }
+            while (stackSize > 0) {
+                stackSize--;
+                merge<ItemType, compOp>(a, stack[stackSize].begin, begin,
+                        count, buffer);
+                begin = stack[stackSize].begin;
+            }
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t PowerSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * (count / 2);
+    }
+
+    /*
+     * stable, scratchpad has to hold count / 2 items
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void PowerSort(ItemType * const a, ssize_t const count,
+            int8_t * const scratchpad) {
+        if (count > 1) {
+            privatePowerSort::powersort<ItemType, compOp>(a, count,
+                    (ItemType *) scratchpad);
+        }
+    }
+
+    template<typename ItemType>
+    void PowerSort(ItemType * const a, ssize_t const count,
+            int8_t * const scratchpad) {
+        PowerSort<ItemType, genericComparisonOperator>(a, count, scratchpad);
+    }
+}
+
+#endif	/* SORTMERGEPOWER_HPP */
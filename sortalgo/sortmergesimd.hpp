@@ -0,0 +1,182 @@
+/* 
+ * sortmergesimd.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTMERGESIMD_HPP
+#define	SORTMERGESIMD_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortnetworksimd.hpp"
+
+#include <x86intrin.h>
+
+namespace tarsa {
+
+    namespace privateSimdMergeSort {
+
+        using namespace privateSimdSortingNetwork;
+
+        template<typename ItemType, bool Ascending>
+        bool ordered(ItemType const &a, ItemType const &b) {
+            return Ascending ? a < b : b < a;
+        }
+
+        template<typename ItemType, bool Ascending>
+        void mergeScalar(ItemType const * const left, ssize_t const leftCount,
+                ItemType const * const right, ssize_t const rightCount,
+                ItemType * const target) {
+            ssize_t leftIndex = 0;
+            ssize_t rightIndex = 0;
+            ssize_t targetIndex = 0;
+            while (leftIndex < leftCount && rightIndex < rightCount) {
+                if (ordered<ItemType, Ascending>(right[rightIndex],
+                        left[leftIndex])) {
+                    target[targetIndex++] = right[rightIndex++];
+                } else {
+                    target[targetIndex++] = left[leftIndex++];
+                }
+            }
+            std::copy(left + leftIndex, left + leftCount, target + targetIndex);
+            std::copy(right + rightIndex, right + rightCount,
+                    target + targetIndex + leftCount - leftIndex);
+        }
+
+        /*
+         * keeps the upper half of the last bitonic merge in a register and
+         * refills it from the run with the smaller head
+         */
+        template<typename ItemType, bool Ascending>
+        void merge(ItemType const * const left, ssize_t const leftCount,
+                ItemType const * const right, ssize_t const rightCount,
+                ItemType * const target) {
+            typedef typename LanesFor<ItemType>::type Lanes;
+            ssize_t constexpr L = Lanes::Lanes;
+            if (leftCount < L || rightCount < L) {
+                mergeScalar<ItemType, Ascending>(left, leftCount, right,
+                        rightCount, target);
+                return;
+            }
+            __m256i const flip = Lanes::broadcast(
+                    orderFlip<ItemType, Ascending>());
+            __m256i low = _mm256_xor_si256(flip,
+                    _mm256_loadu_si256((__m256i *) left));
+            __m256i high = _mm256_xor_si256(flip,
+                    _mm256_loadu_si256((__m256i *) right));
+            ssize_t leftIndex = L;
+            ssize_t rightIndex = L;
+            ssize_t targetIndex = 0;
+            bool takeRight;
+            while (true) {
+                mergeRegisters<Lanes>(&low, &high);
+                _mm256_storeu_si256((__m256i *) (target + targetIndex),
+                        _mm256_xor_si256(low, flip));
+                targetIndex += L;
+                takeRight = rightIndex < rightCount
+                        && (leftIndex == leftCount
+                        || ordered<ItemType, Ascending>(right[rightIndex],
+                        left[leftIndex]));
+                if (takeRight ? rightIndex + L > rightCount
+                        : leftIndex + L > leftCount) {
+                    break;
+                }
+                if (takeRight) {
+                    low = _mm256_loadu_si256(
+                            (__m256i *) (right + rightIndex));
+                    rightIndex += L;
+                } else {
+                    low = _mm256_loadu_si256((__m256i *) (left + leftIndex));
+                    leftIndex += L;
+                }
+                low = _mm256_xor_si256(low, flip);
+            }
+
+            // the run with the smaller head has less than a vector left,
+            // so merge it with the pending upper half first
+            ItemType pending[L];
+            ItemType merged[L * 2];
+            _mm256_storeu_si256((__m256i *) pending,
+                    _mm256_xor_si256(high, flip));
+            ItemType const * const shortRun = takeRight
+                    ? right + rightIndex : left + leftIndex;
+            ssize_t const shortCount = takeRight
+                    ? rightCount - rightIndex : leftCount - leftIndex;
+            mergeScalar<ItemType, Ascending>(pending, L, shortRun, shortCount,
+                    merged);
+            if (takeRight) {
+                mergeScalar<ItemType, Ascending>(merged, L + shortCount,
+                        left + leftIndex, leftCount - leftIndex,
+                        target + targetIndex);
+            } else {
+                mergeScalar<ItemType, Ascending>(merged, L + shortCount,
+                        right + rightIndex, rightCount - rightIndex,
+                        target + targetIndex);
+            }
+        }
+
+        template<typename ItemType, bool Ascending>
+        void mergesort(ItemType * const a, ssize_t const count,
+                ItemType * const scratchpad) {
+            ssize_t constexpr BlockSize =
+                    SimdSortingNetworkMaxCount<ItemType>();
+            for (ssize_t start = 0; start < count; start += BlockSize) {
+                SimdSortingNetwork<ItemType, Ascending>(a + start,
+                        std::min(BlockSize, count - start));
+            }
+            ItemType * source = a;
+            ItemType * target = scratchpad;
+            for (ssize_t width = BlockSize; width < count; width *= 2) {
+                for (ssize_t start = 0; start < count; start += width * 2) {
+                    ssize_t const middle = std::min(start + width, count);
+                    ssize_t const end = std::min(start + width * 2, count);
+                    merge<ItemType, Ascending>(source + start, middle - start,
+                            source + middle, end - middle, target + start);
+                }
+                std::swap(source, target);
+            }
+            if (source != a) {
+                std::copy(source, source + count, a);
+            }
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t SimdMergeSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * count;
+    }
+
+    /*
+     * scratchpad has to hold count items
+     */
+    template<typename ItemType, bool Ascending = true>
+    void SimdMergeSort(ItemType * const a, ssize_t const count,
+            int8_t * const scratchpad) {
+        bool constexpr ok = std::is_same<ItemType, int32_t>::value
+                || std::is_same<ItemType, uint32_t>::value
+                || std::is_same<ItemType, int64_t>::value
+                || std::is_same<ItemType, uint64_t>::value;
+        static_assert(ok, "parameters invalid or specialization missing");
+        privateSimdMergeSort::mergesort<ItemType, Ascending>(a, count,
+                (ItemType *) scratchpad);
+    }
+}
+
+#endif	/* SORTMERGESIMD_HPP */
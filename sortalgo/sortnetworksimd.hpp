@@ -0,0 +1,377 @@
+/* 
+ * sortnetworksimd.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTNETWORKSIMD_HPP
+#define	SORTNETWORKSIMD_HPP
+
+#include "sortalgocommon.hpp"
+
+#include <limits>
+#include <type_traits>
+#include <x86intrin.h>
+
+namespace tarsa {
+
+    namespace privateSimdSortingNetwork {
+
+        /*
+         * lanes are compared as signed integers, other orders are mapped
+         * onto that one by xoring with a constant on load and store
+         */
+        struct DwordLanes {
+            static ssize_t constexpr Lanes = 8;
+            static ssize_t constexpr MaxRegisters = 8;
+
+            static __m256i min(__m256i const a, __m256i const b) {
+                return _mm256_min_epi32(a, b);
+            }
+
+            static __m256i max(__m256i const a, __m256i const b) {
+                return _mm256_max_epi32(a, b);
+            }
+
+            static __m256i reverse(__m256i const v) {
+                return _mm256_permutevar8x32_epi32(v,
+                        _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+            }
+
+            static __m256i broadcast(int32_t const value) {
+                return _mm256_set1_epi32(value);
+            }
+
+            static __m256i laneIndices() {
+                return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            }
+
+            static __m256i maskLoad(void const * const source,
+                    __m256i const mask) {
+                return _mm256_maskload_epi32((int const *) source, mask);
+            }
+
+            static void maskStore(void * const target, __m256i const mask,
+                    __m256i const v) {
+                _mm256_maskstore_epi32((int *) target, mask, v);
+            }
+
+            static __m256i laneMask(ssize_t const validLanes) {
+                return _mm256_cmpgt_epi32(_mm256_set1_epi32(validLanes),
+                        laneIndices());
+            }
+
+            static __m256i blendLanes(__m256i const a, __m256i const b,
+                    __m256i const mask) {
+                return _mm256_blendv_epi8(a, b, mask);
+            }
+        };
+
+        struct QwordLanes {
+            static ssize_t constexpr Lanes = 4;
+            static ssize_t constexpr MaxRegisters = 4;
+
+            static __m256i min(__m256i const a, __m256i const b) {
+                return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+            }
+
+            static __m256i max(__m256i const a, __m256i const b) {
+                return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+            }
+
+            static __m256i reverse(__m256i const v) {
+                return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+
+            static __m256i broadcast(int64_t const value) {
+                return _mm256_set1_epi64x(value);
+            }
+
+            static __m256i laneMask(ssize_t const validLanes) {
+                return _mm256_cmpgt_epi64(_mm256_set1_epi64x(validLanes),
+                        _mm256_setr_epi64x(0, 1, 2, 3));
+            }
+
+            static __m256i maskLoad(void const * const source,
+                    __m256i const mask) {
+                return _mm256_maskload_epi64((long long const *) source,
+                        mask);
+            }
+
+            static void maskStore(void * const target, __m256i const mask,
+                    __m256i const v) {
+                _mm256_maskstore_epi64((long long *) target, mask, v);
+            }
+
+            static __m256i blendLanes(__m256i const a, __m256i const b,
+                    __m256i const mask) {
+                return _mm256_blendv_epi8(a, b, mask);
+            }
+        };
+
+        template<typename ItemType>
+        struct LanesFor {
+        };
+
+        template<>
+        struct LanesFor<int32_t> {
+            typedef DwordLanes type;
+            typedef int32_t SignedType;
+        };
+
+        template<>
+        struct LanesFor<uint32_t> {
+            typedef DwordLanes type;
+            typedef int32_t SignedType;
+        };
+
+        template<>
+        struct LanesFor<int64_t> {
+            typedef QwordLanes type;
+            typedef int64_t SignedType;
+        };
+
+        template<>
+        struct LanesFor<uint64_t> {
+            typedef QwordLanes type;
+            typedef int64_t SignedType;
+        };
+
+        template<typename ItemType, bool Ascending>
+        typename LanesFor<ItemType>::SignedType constexpr orderFlip() {
+            typedef typename LanesFor<ItemType>::SignedType SignedType;
+            return (std::is_signed<ItemType>::value ? 0
+                    : std::numeric_limits<SignedType>::min())
+                    ^ (Ascending ? 0 : -1);
+        }
+
+        /*
+         * exchanges every lane with lane (index ^ Partner), the lane with
+         * the higher index keeps the maximum
+         */
+        template<typename Lanes, ssize_t Partner>
+        __m256i exchange(__m256i const v) {
+        }
+
+        template<int Shuffle, int MaxMask>
+        __m256i exchangeDwords(__m256i const v) {
+            __m256i const other = _mm256_shuffle_epi32(v, Shuffle);
+            return _mm256_blend_epi32(_mm256_min_epi32(v, other),
+                    _mm256_max_epi32(v, other), MaxMask);
+        }
+
+        template<>
+        __m256i exchange<DwordLanes, 1>(__m256i const v) {
+            return exchangeDwords<_MM_SHUFFLE(2, 3, 0, 1), 0xAA>(v);
+        }
+
+        template<>
+        __m256i exchange<DwordLanes, 2>(__m256i const v) {
+            return exchangeDwords<_MM_SHUFFLE(1, 0, 3, 2), 0xCC>(v);
+        }
+
+        template<>
+        __m256i exchange<DwordLanes, 3>(__m256i const v) {
+            return exchangeDwords<_MM_SHUFFLE(0, 1, 2, 3), 0xCC>(v);
+        }
+
+        template<>
+        __m256i exchange<DwordLanes, 4>(__m256i const v) {
+            __m256i const other = _mm256_permute2x128_si256(v, v, 1);
+            return _mm256_blend_epi32(_mm256_min_epi32(v, other),
+                    _mm256_max_epi32(v, other), 0xF0);
+        }
+
+        template<>
+        __m256i exchange<DwordLanes, 7>(__m256i const v) {
+            __m256i const other = DwordLanes::reverse(v);
+            return _mm256_blend_epi32(_mm256_min_epi32(v, other),
+                    _mm256_max_epi32(v, other), 0xF0);
+        }
+
+        template<int Shuffle, int MaxMask>
+        __m256i exchangeQwords(__m256i const v) {
+            __m256i const other = _mm256_permute4x64_epi64(v, Shuffle);
+            return _mm256_blend_epi32(QwordLanes::min(v, other),
+                    QwordLanes::max(v, other), MaxMask);
+        }
+
+        template<>
+        __m256i exchange<QwordLanes, 1>(__m256i const v) {
+            return exchangeQwords<_MM_SHUFFLE(2, 3, 0, 1), 0xCC>(v);
+        }
+
+        template<>
+        __m256i exchange<QwordLanes, 2>(__m256i const v) {
+            return exchangeQwords<_MM_SHUFFLE(1, 0, 3, 2), 0xF0>(v);
+        }
+
+        template<>
+        __m256i exchange<QwordLanes, 3>(__m256i const v) {
+            return exchangeQwords<_MM_SHUFFLE(0, 1, 2, 3), 0xF0>(v);
+        }
+
+        template<typename Lanes>
+        __m256i sortRegister(__m256i v) {
+        }
+
+        template<>
+        __m256i sortRegister<DwordLanes>(__m256i v) {
+            v = exchange<DwordLanes, 1>(v);
+            v = exchange<DwordLanes, 3>(v);
+            v = exchange<DwordLanes, 1>(v);
+            v = exchange<DwordLanes, 7>(v);
+            v = exchange<DwordLanes, 2>(v);
+            return exchange<DwordLanes, 1>(v);
+        }
+
+        template<>
+        __m256i sortRegister<QwordLanes>(__m256i v) {
+            v = exchange<QwordLanes, 1>(v);
+            v = exchange<QwordLanes, 3>(v);
+            return exchange<QwordLanes, 1>(v);
+        }
+
+        /*
+         * sorts a register which holds a sequence already split into
+         * ordered halves, quarters, etc. (last stages of bitonic merge)
+         */
+        template<typename Lanes>
+        __m256i cleanRegister(__m256i v) {
+        }
+
+        template<>
+        __m256i cleanRegister<DwordLanes>(__m256i v) {
+            v = exchange<DwordLanes, 4>(v);
+            v = exchange<DwordLanes, 2>(v);
+            return exchange<DwordLanes, 1>(v);
+        }
+
+        template<>
+        __m256i cleanRegister<QwordLanes>(__m256i v) {
+            v = exchange<QwordLanes, 2>(v);
+            return exchange<QwordLanes, 1>(v);
+        }
+
+        /*
+         * merges two ascending registers, lower half ends up in first
+         */
+        template<typename Lanes>
+        void mergeRegisters(__m256i * const first, __m256i * const second) {
+            __m256i const reversed = Lanes::reverse(*second);
+            *second = cleanRegister<Lanes>(Lanes::max(*first, reversed));
+            *first = cleanRegister<Lanes>(Lanes::min(*first, reversed));
+        }
+
+        /*
+         * bitonic sort with the flip variant of merge steps, so that every
+         * block is sorted ascending and no direction masks are needed
+         */
+        template<typename Lanes, ssize_t Registers>
+        void sortRegisters(__m256i * const v) {
+            for (ssize_t r = 0; r < Registers; r++) {
+                v[r] = sortRegister<Lanes>(v[r]);
+            }
+            for (ssize_t block = 2; block <= Registers; block *= 2) {
+                for (ssize_t start = 0; start < Registers; start += block) {
+                    for (ssize_t r = 0; r < block / 2; r++) {
+                        __m256i const low = v[start + r];
+                        __m256i const high = Lanes::reverse(
+                                v[start + block - 1 - r]);
+                        v[start + r] = Lanes::min(low, high);
+                        v[start + block - 1 - r] = Lanes::reverse(
+                                Lanes::max(low, high));
+                    }
+                }
+                for (ssize_t step = block / 4; step >= 1; step /= 2) {
+                    for (ssize_t r = 0; r < Registers; r++) {
+                        if ((r & step) == 0) {
+                            __m256i const low = v[r];
+                            __m256i const high = v[r + step];
+                            v[r] = Lanes::min(low, high);
+                            v[r + step] = Lanes::max(low, high);
+                        }
+                    }
+                }
+                for (ssize_t r = 0; r < Registers; r++) {
+                    v[r] = cleanRegister<Lanes>(v[r]);
+                }
+            }
+        }
+
+        template<typename ItemType, bool Ascending, ssize_t Registers>
+        void sortSmall(ItemType * const a, ssize_t const count) {
+            typedef typename LanesFor<ItemType>::type Lanes;
+            __m256i const flip = Lanes::broadcast(
+                    orderFlip<ItemType, Ascending>());
+            __m256i const sentinel = Lanes::broadcast(
+                    std::numeric_limits<typename LanesFor<ItemType>::
+                    SignedType>::max());
+            __m256i masks[Registers];
+            __m256i v[Registers];
+            for (ssize_t r = 0; r < Registers; r++) {
+                masks[r] = Lanes::laneMask(count - r * Lanes::Lanes);
+                v[r] = Lanes::blendLanes(sentinel, _mm256_xor_si256(
+                        Lanes::maskLoad(a + r * Lanes::Lanes, masks[r]), flip),
+                        masks[r]);
+            }
+            sortRegisters<Lanes, Registers>(v);
+            for (ssize_t r = 0; r < Registers; r++) {
+                Lanes::maskStore(a + r * Lanes::Lanes, masks[r],
+                        _mm256_xor_si256(v[r], flip));
+            }
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t constexpr SimdSortingNetworkMaxCount() {
+        return privateSimdSortingNetwork::LanesFor<ItemType>::type::Lanes
+                * privateSimdSortingNetwork::LanesFor<ItemType>::type::
+                MaxRegisters;
+    }
+
+    /*
+     * sorts up to 64 dwords or 16 qwords in registers
+     */
+    template<typename ItemType, bool Ascending = true>
+    void SimdSortingNetwork(ItemType * const a, ssize_t const count) {
+        bool constexpr ok = std::is_same<ItemType, int32_t>::value
+                || std::is_same<ItemType, uint32_t>::value
+                || std::is_same<ItemType, int64_t>::value
+                || std::is_same<ItemType, uint64_t>::value;
+        static_assert(ok, "parameters invalid or specialization missing");
+        using namespace privateSimdSortingNetwork;
+        ssize_t constexpr Lanes = LanesFor<ItemType>::type::Lanes;
+        assert(count <= SimdSortingNetworkMaxCount<ItemType>());
+        if (count <= 1) {
+        } else if (count <= Lanes) {
+            sortSmall<ItemType, Ascending, 1>(a, count);
+        } else if (count <= Lanes * 2) {
+            sortSmall<ItemType, Ascending, 2>(a, count);
+        } else if (count <= Lanes * 4) {
+            sortSmall<ItemType, Ascending, 4>(a, count);
+        } else {
+            sortSmall<ItemType, Ascending,
+                    LanesFor<ItemType>::type::MaxRegisters>(a, count);
+        }
+    }
+}
+
+#endif	/* SORTNETWORKSIMD_HPP */
@@ -0,0 +1,190 @@
+/* 
+ * sortpartial.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTPARTIAL_HPP
+#define	SORTPARTIAL_HPP
+
+#include "priorityqueue.hpp"
+#include "sortalgocommon.hpp"
+
+#include <type_traits>
+
+namespace tarsa {
+
+    namespace privatePartialSort {
+
+        /*
+         * a bounded heap scan touches every item once but pays log k for
+         * each replacement, heapifying everything pays a linear build
+         * and log n per drained item; the scan wins for small k
+         */
+        ssize_t constexpr BoundedHeapMaxFraction = 16;
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        bool reversed(ItemType const leftOp, ComparisonType const opType,
+                ItemType const rightOp) {
+            return compOp(rightOp, opType, leftOp);
+        }
+
+        using privatePriorityQueue::drainHeap;
+        using privatePriorityQueue::heapify;
+        using privatePriorityQueue::siftDown;
+
+        /*
+         * heap holds the k items Below all others seen so far, its leader
+         * is the one to evict; with Swap the evicted items go back to the
+         * source, so the whole array stays a permutation of the input
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Layout, bool Swap>
+        void boundedScan(ItemType * const heap, ssize_t const k,
+                ItemType * const source, ssize_t const begin,
+                ssize_t const end) {
+            heapify<ItemType, compOp, Layout>(heap, k);
+            ssize_t top = Layout::template leader<ItemType, compOp>(heap, 0, k);
+            for (ssize_t item = begin; item < end; item++) {
+                if (compOp(source[item], Below, heap[top])) {
+                    if (Swap) {
+                        std::swap(source[item], heap[top]);
+                    } else {
+                        heap[top] = source[item];
+                    }
+                    siftDown<ItemType, compOp, Layout>(heap, k, top);
+                    top = Layout::template leader<ItemType, compOp>(heap, 0,
+                            k);
+                }
+            }
+            drainHeap<ItemType, compOp, Layout>(heap, k, k);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        ComparisonOperator<ItemType> reverseOp, typename Layout>
+        void partialSort(ItemType * const a, ssize_t const count,
+                ssize_t const k) {
+            if (k * BoundedHeapMaxFraction <= count) {
+                boundedScan<ItemType, compOp, Layout, true>(a, k, a, k, count);
+            } else {
+                // a reversed heap drains the smallest items to the end,
+                // smallest last
+                heapify<ItemType, reverseOp, Layout>(a, count);
+                drainHeap<ItemType, reverseOp, Layout>(a, count, k);
+                std::reverse(a + count - k, a + count);
+                std::rotate(a, a + count - k, a + count);
+            }
+        }
+
+        /*
+         * the SIMD layout needs dwords and aligned child groups
+         */
+        template<typename ItemType>
+        struct FastLayout {
+            typedef typename std::conditional<
+            std::is_same<ItemType, int32_t>::value
+            || std::is_same<ItemType, uint32_t>::value,
+            SimdDwordHeapLayout, QuaternaryHeapLayout>::type Type;
+
+            static bool usable(ItemType const * const a) {
+                return (uintptr_t) a % Type::ArrayAlignment == 0;
+            }
+        };
+    }
+
+    /*
+     * moves the k items Below all others to the front, sorted; the order of
+     * the remaining items is unspecified
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void PartialSort(ItemType * const a, ssize_t const count, ssize_t k) {
+        using namespace privatePartialSort;
+        k = std::min(k, count);
+        if (k > 0) {
+            partialSort<ItemType, compOp, reversed<ItemType, compOp>,
+                    QuaternaryHeapLayout>(a, count, k);
+        }
+    }
+
+    /*
+     * dword items use the SIMD heap when the array is 32 byte aligned
+     */
+    template<typename ItemType>
+    void PartialSort(ItemType * const a, ssize_t const count, ssize_t k) {
+        using namespace privatePartialSort;
+        typedef FastLayout<ItemType> Fast;
+        k = std::min(k, count);
+        if (k <= 0) {
+            return;
+        }
+        if (Fast::usable(a)) {
+            partialSort<ItemType, genericComparisonOperator,
+                    genericReverseComparisonOperator,
+                    typename Fast::Type>(a, count, k);
+        } else {
+            partialSort<ItemType, genericComparisonOperator,
+                    genericReverseComparisonOperator,
+                    QuaternaryHeapLayout>(a, count, k);
+        }
+    }
+
+    /*
+     * writes the k items Below all others to out, sorted, and leaves the
+     * input untouched; with no room to heapify the input it always scans
+     * with a bounded heap in out
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void TopK(ItemType const * const a, ssize_t const count, ssize_t k,
+            ItemType * const out) {
+        k = std::min(k, count);
+        if (k > 0) {
+            std::copy(a, a + k, out);
+            privatePartialSort::boundedScan<ItemType, compOp,
+                    QuaternaryHeapLayout, false>(out, k, (ItemType *) a, k,
+                    count);
+        }
+    }
+
+    /*
+     * dword items use the SIMD heap when out is 32 byte aligned
+     */
+    template<typename ItemType>
+    void TopK(ItemType const * const a, ssize_t const count, ssize_t k,
+            ItemType * const out) {
+        using namespace privatePartialSort;
+        typedef FastLayout<ItemType> Fast;
+        k = std::min(k, count);
+        if (k <= 0) {
+            return;
+        }
+        std::copy(a, a + k, out);
+        if (Fast::usable(out)) {
+            boundedScan<ItemType, genericComparisonOperator,
+                    typename Fast::Type, false>(out, k, (ItemType *) a, k,
+                    count);
+        } else {
+            boundedScan<ItemType, genericComparisonOperator,
+                    QuaternaryHeapLayout, false>(out, k, (ItemType *) a, k,
+                    count);
+        }
+    }
+}
+
+#endif	/* SORTPARTIAL_HPP */
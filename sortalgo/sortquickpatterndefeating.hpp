@@ -0,0 +1,368 @@
+/* 
+ * sortquickpatterndefeating.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTQUICKPATTERNDEFEATING_HPP
+#define	SORTQUICKPATTERNDEFEATING_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheaphybridcascading.hpp"
+
+namespace tarsa {
+
+    /*
+     * based on: https://github.com/orlp/pdqsort (partitioning scheme from
+     * "BlockQuicksort: How Branch Mispredictions don't affect Quicksort")
+     */
+    namespace privatePatternDefeatingQuickSort {
+
+        ssize_t constexpr InsertionSortThreshold = 24;
+        ssize_t constexpr NintherThreshold = 128;
+        ssize_t constexpr PartialInsertionSortLimit = 8;
+        ssize_t constexpr BlockSize = 64;
+        ssize_t constexpr CacheLineSize = 64;
+
+        ssize_t log2(ssize_t count) {
+            ssize_t result = 0;
+            while (count >>= 1) {
+                result++;
+            }
+            return result;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void insertionSort(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            for (ssize_t current = begin + 1; current < end; current++) {
+                if (compOp(a[current], Below, a[current - 1])) {
+                    ItemType const item = a[current];
+                    ssize_t hole = current;
+                    do {
+                        a[hole] = a[hole - 1];
+                        hole--;
+                    } while (hole > begin && compOp(item, Below, a[hole - 1]));
+                    a[hole] = item;
+                }
+            }
+        }
+
+        /*
+         * requires a[begin - 1] not to be above any item in [begin, end)
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void unguardedInsertionSort(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            for (ssize_t current = begin + 1; current < end; current++) {
+                if (compOp(a[current], Below, a[current - 1])) {
+                    ItemType const item = a[current];
+                    ssize_t hole = current;
+                    do {
+                        a[hole] = a[hole - 1];
+                        hole--;
+                    } while (compOp(item, Below, a[hole - 1]));
+                    a[hole] = item;
+                }
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        bool partialInsertionSort(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            ssize_t moves = 0;
+            for (ssize_t current = begin + 1; current < end; current++) {
+                if (compOp(a[current], Below, a[current - 1])) {
+                    ItemType const item = a[current];
+                    ssize_t hole = current;
+                    do {
+                        a[hole] = a[hole - 1];
+                        hole--;
+                    } while (hole > begin && compOp(item, Below, a[hole - 1]));
+                    a[hole] = item;
+                    moves += current - hole;
+                }
+                if (moves > PartialInsertionSortLimit) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void sort2(ItemType * const a, ssize_t const i, ssize_t const j) {
+            if (compOp(a[j], Below, a[i])) {
+                std::swap(a[i], a[j]);
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void sort3(ItemType * const a, ssize_t const i, ssize_t const j,
+                ssize_t const k) {
+            sort2<ItemType, compOp>(a, i, j);
+            sort2<ItemType, compOp>(a, j, k);
+            sort2<ItemType, compOp>(a, i, j);
+        }
+
+        template<typename ItemType>
+        void swapOffsets(ItemType * const a, ssize_t const leftBase,
+                ssize_t const rightBase, uint8_t const * const leftOffsets,
+                uint8_t const * const rightOffsets, ssize_t const count,
+                bool const useSwaps) {
+            if (useSwaps) {
+                // keeps descending inputs linear
+                for (ssize_t i = 0; i < count; i++) {
+                    std::swap(a[leftBase + leftOffsets[i]],
+                            a[rightBase - rightOffsets[i]]);
+                }
+            } else if (count > 0) {
+                ssize_t left = leftBase + leftOffsets[0];
+                ssize_t right = rightBase - rightOffsets[0];
+                ItemType const item = a[left];
+                a[left] = a[right];
+                for (ssize_t i = 1; i < count; i++) {
+                    left = leftBase + leftOffsets[i];
+                    a[right] = a[left];
+                    right = rightBase - rightOffsets[i];
+                    a[left] = a[right];
+                }
+                a[right] = item;
+            }
+        }
+
+        /*
+         * partitions [begin, end) around a[begin], items equal to pivot go
+         * to the right; requires median of 3 to be already placed at begin
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        ssize_t partitionRightBranchless(ItemType * const a,
+                ssize_t const begin, ssize_t const end,
+                bool * const alreadyPartitioned) {
+            ItemType const pivot = a[begin];
+            ssize_t first = begin;
+            ssize_t last = end;
+
+            while (compOp(a[++first], Below, pivot));
+            if (first - 1 == begin) {
+                while (first < last && !compOp(a[--last], Below, pivot));
+            } else {
+                while (!compOp(a[--last], Below, pivot));
+            }
+
+            *alreadyPartitioned = first >= last;
+            if (!*alreadyPartitioned) {
+                std::swap(a[first], a[last]);
+                first++;
+
+                alignas(CacheLineSize) uint8_t leftOffsets[BlockSize];
+                alignas(CacheLineSize) uint8_t rightOffsets[BlockSize];
+
+                ssize_t leftBase = first;
+                ssize_t rightBase = last;
+                ssize_t leftCount = 0;
+                ssize_t rightCount = 0;
+                ssize_t leftStart = 0;
+                ssize_t rightStart = 0;
+
+                while (first < last) {
+                    ssize_t const unknown = last - first;
+                    ssize_t const leftSplit = leftCount == 0 ? (rightCount == 0
+                            ? unknown / 2 : unknown) : 0;
+                    ssize_t const rightSplit = rightCount == 0
+                            ? unknown - leftSplit : 0;
+
+                    ssize_t const leftScan = std::min(leftSplit, BlockSize);
+                    for (ssize_t i = 0; i < leftScan; i++) {
+                        leftOffsets[leftCount] = i;
+                        leftCount += !compOp(a[first], Below, pivot);
+                        first++;
+                    }
+                    ssize_t const rightScan = std::min(rightSplit, BlockSize);
+                    for (ssize_t i = 1; i <= rightScan; i++) {
+                        rightOffsets[rightCount] = i;
+                        rightCount += compOp(a[--last], Below, pivot);
+                    }
+
+                    ssize_t const swaps = std::min(leftCount, rightCount);
+                    swapOffsets(a, leftBase, rightBase,
+                            leftOffsets + leftStart, rightOffsets + rightStart,
+                            swaps, leftCount == rightCount);
+                    leftCount -= swaps;
+                    rightCount -= swaps;
+                    leftStart += swaps;
+                    rightStart += swaps;
+
+                    if (leftCount == 0) {
+                        leftStart = 0;
+                        leftBase = first;
+                    }
+                    if (rightCount == 0) {
+                        rightStart = 0;
+                        rightBase = last;
+                    }
+                }
+
+                if (leftCount > 0) {
+                    while (leftCount-- > 0) {
+                        std::swap(a[leftBase + leftOffsets[leftStart
+                                + leftCount]], a[--last]);
+                    }
+                    first = last;
+                }
+                if (rightCount > 0) {
+                    while (rightCount-- > 0) {
+                        std::swap(a[rightBase - rightOffsets[rightStart
+                                + rightCount]], a[first]);
+                        first++;
+                    }
+                    last = first;
+                }
+            }
+
+            ssize_t const pivotPosition = first - 1;
+            a[begin] = a[pivotPosition];
+            a[pivotPosition] = pivot;
+            return pivotPosition;
+        }
+
+        /*
+         * partitions [begin, end) around a[begin], items equal to pivot go
+         * to the left; used when a[begin - 1] equals the chosen pivot
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        ssize_t partitionLeft(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            ItemType const pivot = a[begin];
+            ssize_t first = begin;
+            ssize_t last = end;
+
+            while (compOp(pivot, Below, a[--last]));
+            if (last + 1 == end) {
+                while (first < last && !compOp(pivot, Below, a[++first]));
+            } else {
+                while (!compOp(pivot, Below, a[++first]));
+            }
+            while (first < last) {
+                std::swap(a[first], a[last]);
+                while (compOp(pivot, Below, a[--last]));
+                while (!compOp(pivot, Below, a[++first]));
+            }
+
+            a[begin] = a[last];
+            a[last] = pivot;
+            return last;
+        }
+
+        template<typename ItemType>
+        void breakPatterns(ItemType * const a, ssize_t const begin,
+                ssize_t const end) {
+            ssize_t const size = end - begin;
+            if (size >= InsertionSortThreshold) {
+                std::swap(a[begin], a[begin + size / 4]);
+                std::swap(a[end - 1], a[end - size / 4]);
+                if (size > NintherThreshold) {
+                    std::swap(a[begin + 1], a[begin + (size / 4 + 1)]);
+                    std::swap(a[begin + 2], a[begin + (size / 4 + 2)]);
+                    std::swap(a[end - 2], a[end - (size / 4 + 1)]);
+                    std::swap(a[end - 3], a[end - (size / 4 + 2)]);
+                }
+            }
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void quicksort(ItemType * const a, ssize_t begin, ssize_t const end,
+                ssize_t badPartitionsAllowed, bool leftmost) {
+            while (true) {
+                ssize_t const size = end - begin;
+                if (size < InsertionSortThreshold) {
+                    if (leftmost) {
+                        insertionSort<ItemType, compOp>(a, begin, end);
+                    } else {
+                        unguardedInsertionSort<ItemType, compOp>(a, begin, end);
+                    }
+                    return;
+                }
+
+                ssize_t const half = size / 2;
+                if (size > NintherThreshold) {
+                    sort3<ItemType, compOp>(a, begin, begin + half, end - 1);
+                    sort3<ItemType, compOp>(a, begin + 1, begin + half - 1,
+                            end - 2);
+                    sort3<ItemType, compOp>(a, begin + 2, begin + half + 1,
+                            end - 3);
+                    sort3<ItemType, compOp>(a, begin + half - 1, begin + half,
+                            begin + half + 1);
+                    std::swap(a[begin], a[begin + half]);
+                } else {
+                    sort3<ItemType, compOp>(a, begin + half, begin, end - 1);
+                }
+
+                if (!leftmost && !compOp(a[begin - 1], Below, a[begin])) {
+                    begin = partitionLeft<ItemType, compOp>(a, begin, end) + 1;
+                    continue;
+                }
+
+                bool alreadyPartitioned;
+                ssize_t const pivotPosition = partitionRightBranchless<ItemType,
+                        compOp>(a, begin, end, &alreadyPartitioned);
+
+                ssize_t const leftSize = pivotPosition - begin;
+                ssize_t const rightSize = end - (pivotPosition + 1);
+                if (leftSize < size / 8 || rightSize < size / 8) {
+                    if (--badPartitionsAllowed == 0) {
+                        HybridCascadingHeapSort<ItemType, compOp>(a + begin,
+                                size);
+                        return;
+                    }
+                    breakPatterns(a, begin, pivotPosition);
+                    breakPatterns(a, pivotPosition + 1, end);
+                } else if (alreadyPartitioned
+                        && partialInsertionSort<ItemType, compOp>(
+                        a, begin, pivotPosition)
+                        && partialInsertionSort<ItemType, compOp>(
+                        a, pivotPosition + 1, end)) {
+                    return;
+                }
+
+                quicksort<ItemType, compOp>(a, begin, pivotPosition,
+                        badPartitionsAllowed, leftmost);
+                begin = pivotPosition + 1;
+                leftmost = false;
+            }
+        }
+    }
+
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void PatternDefeatingQuickSort(ItemType * const a, ssize_t const count) {
+        if (count > 1) {
+            privatePatternDefeatingQuickSort::quicksort<ItemType, compOp>(
+                    a, 0, count, privatePatternDefeatingQuickSort::log2(count),
+                    true);
+        }
+    }
+
+    template<typename ItemType>
+    void PatternDefeatingQuickSort(ItemType * const a, ssize_t const count) {
+        PatternDefeatingQuickSort<ItemType, genericComparisonOperator>(
+                a, count);
+    }
+}
+
+#endif	/* SORTQUICKPATTERNDEFEATING_HPP */
@@ -0,0 +1,294 @@
+/* 
+ * sortquicksimddword.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTQUICKSIMDDWORD_HPP
+#define	SORTQUICKSIMDDWORD_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheaphybridcascading.hpp"
+#include "sortnetworksimd.hpp"
+
+#include <x86intrin.h>
+
+namespace tarsa {
+
+    namespace privateSimdDwordQuickSort {
+
+        ssize_t constexpr VectorSize = 8;
+
+        ssize_t constexpr SmallSortThreshold =
+                SimdSortingNetworkMaxCount<int32_t>();
+
+        template<typename ItemType, bool Ascending>
+        bool ordered(ItemType const &a, ItemType const &b) {
+        }
+
+        template<>
+        bool ordered<int32_t, true>(int32_t const &a, int32_t const &b) {
+            return a < b;
+        }
+
+        template<>
+        bool ordered<uint32_t, true>(uint32_t const &a, uint32_t const &b) {
+            return a < b;
+        }
+
+        template<>
+        bool ordered<int32_t, false>(int32_t const &a, int32_t const &b) {
+            return a > b;
+        }
+
+        template<>
+        bool ordered<uint32_t, false>(uint32_t const &a, uint32_t const &b) {
+            return a > b;
+        }
+
+        template<bool Signed, bool Ascending>
+        __m256i verticalOrdered(__m256i const a, __m256i const b) {
+        }
+
+        template<>
+        __m256i verticalOrdered<true, true>(__m256i const a, __m256i const b) {
+            return _mm256_cmpgt_epi32(b, a);
+        }
+
+        template<>
+        __m256i verticalOrdered<false, true>(__m256i const a, __m256i const b) {
+            __m256i const bias = _mm256_set1_epi32(INT32_MIN);
+            return _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias),
+                    _mm256_xor_si256(a, bias));
+        }
+
+        template<>
+        __m256i verticalOrdered<true, false>(__m256i const a, __m256i const b) {
+            return _mm256_cmpgt_epi32(a, b);
+        }
+
+        template<>
+        __m256i verticalOrdered<false, false>(
+                __m256i const a, __m256i const b) {
+            __m256i const bias = _mm256_set1_epi32(INT32_MIN);
+            return _mm256_cmpgt_epi32(_mm256_xor_si256(a, bias),
+                    _mm256_xor_si256(b, bias));
+        }
+
+        using namespace compileTimeConstArrays;
+
+        /*
+         * lanes with cleared mask bits go first, lanes with set bits last,
+         * each output lane index is packed into a nibble
+         */
+        uint32_t constexpr compPermutation(ssize_t const mask,
+                ssize_t const lane, ssize_t const position) {
+            return lane == VectorSize * 2 ? 0
+                    : ((mask >> (lane % VectorSize)) & 1) == lane / VectorSize
+                    ? ((lane % VectorSize) << (position * 4))
+                    | compPermutation(mask, lane + 1, position + 1)
+                    : compPermutation(mask, lane + 1, position);
+        }
+
+        uint32_t constexpr compPermutation(ssize_t const mask) {
+            return compPermutation(mask, 0, 0);
+        }
+
+        ComputedArray<1 << VectorSize, uint32_t> getPermutation(
+                gen_seq<1 << VectorSize>(), compPermutation);
+
+        /*
+         * stores the partitioned vector at both write heads, so both
+         * heads need at least VectorSize free slots
+         */
+        void partitionVector(int32_t * const a, __m256i const vector,
+                int32_t const rightMask, ssize_t * const leftWrite,
+                ssize_t * const rightWrite) {
+            ssize_t const rightCount = __builtin_popcount(rightMask);
+            __m256i const permutation = _mm256_and_si256(_mm256_srlv_epi32(
+                    _mm256_set1_epi32(getPermutation[rightMask]),
+                    _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28)),
+                    _mm256_set1_epi32(VectorSize - 1));
+            __m256i const permuted = _mm256_permutevar8x32_epi32(vector,
+                    permutation);
+            _mm256_storeu_si256((__m256i *) (a + *leftWrite), permuted);
+            _mm256_storeu_si256((__m256i *) (a + *rightWrite - VectorSize),
+                    permuted);
+            *leftWrite += VectorSize - rightCount;
+            *rightWrite -= rightCount;
+        }
+
+        /*
+         * PivotGoesLeft selects between [<= pivot, > pivot) and
+         * [< pivot, >= pivot) split (for ascending order)
+         */
+        template<typename ItemType, bool Signed, bool Ascending,
+        bool PivotGoesLeft>
+        int32_t rightMask(__m256i const vector, __m256i const pivot) {
+            if (PivotGoesLeft) {
+                return _mm256_movemask_ps(_mm256_castsi256_ps(
+                        verticalOrdered<Signed, Ascending>(pivot, vector)));
+            } else {
+                return ~_mm256_movemask_ps(_mm256_castsi256_ps(
+                        verticalOrdered<Signed, Ascending>(vector, pivot)))
+                        & ((1 << VectorSize) - 1);
+            }
+        }
+
+        template<typename ItemType, bool Ascending, bool PivotGoesLeft>
+        bool goesRight(ItemType const item, ItemType const pivot) {
+            return PivotGoesLeft ? ordered<ItemType, Ascending>(pivot, item)
+                    : !ordered<ItemType, Ascending>(item, pivot);
+        }
+
+        template<typename ItemType, bool Signed, bool Ascending,
+        bool PivotGoesLeft>
+        ssize_t partition(ItemType * const a, ssize_t const left,
+                ssize_t const right, ItemType const pivot) {
+            assert(right - left >= VectorSize * 2);
+            int32_t * const items = (int32_t *) a;
+            __m256i const pivotVector = _mm256_set1_epi32(pivot);
+            __m256i const leftVector = _mm256_loadu_si256(
+                    (__m256i *) (items + left));
+            __m256i const rightVector = _mm256_loadu_si256(
+                    (__m256i *) (items + right - VectorSize));
+            ssize_t leftWrite = left;
+            ssize_t rightWrite = right;
+            ssize_t leftRead = left + VectorSize;
+            ssize_t rightRead = right - VectorSize;
+
+            for (ssize_t remainder = (rightRead - leftRead) % VectorSize;
+                    remainder > 0; remainder--) {
+                ItemType const item = a[leftRead++];
+                if (goesRight<ItemType, Ascending, PivotGoesLeft>(
+                        item, pivot)) {
+                    a[--rightWrite] = item;
+                } else {
+                    a[leftWrite++] = item;
+                }
+            }
+            while (leftRead < rightRead) {
+                __m256i vector;
+                if (leftRead - leftWrite <= rightWrite - rightRead) {
+                    vector = _mm256_loadu_si256((__m256i *) (items + leftRead));
+                    leftRead += VectorSize;
+                } else {
+                    rightRead -= VectorSize;
+                    vector = _mm256_loadu_si256(
+                            (__m256i *) (items + rightRead));
+                }
+                partitionVector(items, vector, rightMask<ItemType, Signed,
+                        Ascending, PivotGoesLeft>(vector, pivotVector),
+                        &leftWrite, &rightWrite);
+            }
+            assert(rightWrite - leftWrite == VectorSize * 2);
+            partitionVector(items, leftVector, rightMask<ItemType, Signed,
+                    Ascending, PivotGoesLeft>(leftVector, pivotVector),
+                    &leftWrite, &rightWrite);
+            partitionVector(items, rightVector, rightMask<ItemType, Signed,
+                    Ascending, PivotGoesLeft>(rightVector, pivotVector),
+                    &leftWrite, &rightWrite);
+            assert(leftWrite == rightWrite);
+            return leftWrite;
+        }
+
+        template<typename ItemType, bool Ascending>
+        ItemType medianOf3(ItemType const x, ItemType const y,
+                ItemType const z) {
+            if (ordered<ItemType, Ascending>(x, y)) {
+                return ordered<ItemType, Ascending>(y, z) ? y
+                        : ordered<ItemType, Ascending>(x, z) ? z : x;
+            } else {
+                return ordered<ItemType, Ascending>(x, z) ? x
+                        : ordered<ItemType, Ascending>(y, z) ? z : y;
+            }
+        }
+
+        template<typename ItemType, bool Ascending>
+        ItemType selectPivot(ItemType const * const a, ssize_t const left,
+                ssize_t const right) {
+            ssize_t const step = (right - left) / 8;
+            ssize_t const middle = left + (right - left) / 2;
+            return medianOf3<ItemType, Ascending>(
+                    medianOf3<ItemType, Ascending>(a[left], a[left + step],
+                    a[left + step * 2]),
+                    medianOf3<ItemType, Ascending>(a[middle - step], a[middle],
+                    a[middle + step]),
+                    medianOf3<ItemType, Ascending>(a[right - 1 - step * 2],
+                    a[right - 1 - step], a[right - 1]));
+        }
+
+        template<typename ItemType, bool Signed, bool Ascending, bool Payload>
+        void quicksort(ItemType * const a, ssize_t left, ssize_t right,
+                ssize_t depthLimit) {
+            while (right - left > SmallSortThreshold) {
+                if (depthLimit-- == 0) {
+                    if (Ascending) {
+                        HybridCascadingHeapSort<ItemType,
+                                genericComparisonOperator>(
+                                a + left, right - left);
+                    } else {
+                        HybridCascadingHeapSort<ItemType,
+                                genericReverseComparisonOperator>(
+                                a + left, right - left);
+                    }
+                    return;
+                }
+                ItemType const pivot = selectPivot<ItemType, Ascending>(
+                        a, left, right);
+                ssize_t middle = partition<ItemType, Signed, Ascending, true>(
+                        a, left, right, pivot);
+                if (middle == right) {
+                    // pivot is the last item in order, so peel off its copies
+                    right = partition<ItemType, Signed, Ascending, false>(
+                            a, left, right, pivot);
+                    continue;
+                }
+                if (middle - left < right - middle) {
+                    quicksort<ItemType, Signed, Ascending, Payload>(
+                            a, left, middle, depthLimit);
+                    left = middle;
+                } else {
+                    quicksort<ItemType, Signed, Ascending, Payload>(
+                            a, middle, right, depthLimit);
+                    right = middle;
+                }
+            }
+            SimdSortingNetwork<ItemType, Ascending>(a + left, right - left);
+        }
+    }
+
+    template<typename ItemType, bool Ascending = true, bool Payload = false >
+    void SimdDwordQuickSort(ItemType * const a, ssize_t const count) {
+        static_assert(Payload == false, "payload not implemented");
+        bool constexpr ok = std::is_same<ItemType, int32_t>::value
+                || std::is_same<ItemType, uint32_t>::value;
+        static_assert(ok, "parameters invalid or specialization missing");
+        ssize_t depthLimit = 0;
+        for (ssize_t remaining = count; remaining > 1; remaining >>= 1) {
+            depthLimit += 2;
+        }
+        privateSimdDwordQuickSort::quicksort<ItemType,
+                std::is_same<ItemType, int32_t>::value, Ascending, Payload>(
+                a, 0, count, depthLimit);
+    }
+}
+
+#endif	/* SORTQUICKSIMDDWORD_HPP */
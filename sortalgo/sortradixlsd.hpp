@@ -0,0 +1,217 @@
+/* 
+ * sortradixlsd.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTRADIXLSD_HPP
+#define	SORTRADIXLSD_HPP
+
+#include "sortalgocommon.hpp"
+
+namespace tarsa {
+
+    namespace privateLsdRadixSort {
+
+        using namespace privateRadixSorts;
+
+        ssize_t constexpr WriteCombiningBytes = 64;
+        /*
+         * 256 write combining buffers take 16 KiB of stack and fit in L1
+         * with the histogram, 11 bit digits save a pass on 32 bit keys but
+         * need 128 KiB of buffers, twice that with payloads
+         */
+        ssize_t constexpr DefaultDigitBits = 8;
+
+        template<typename ItemType, ssize_t DigitBits>
+        ssize_t constexpr passesCount() {
+            return (sizeof (ItemType) * 8 + DigitBits - 1) / DigitBits;
+        }
+
+        template<typename ItemType, bool Ascending, ssize_t DigitBits>
+        void computeHistograms(ItemType const * const a, ssize_t const count,
+                ssize_t * const histograms) {
+            ssize_t constexpr Passes = passesCount<ItemType, DigitBits>();
+            ssize_t constexpr Buckets = 1 << DigitBits;
+            for (ssize_t item = 0; item < count; item++) {
+                typename KeyTraits<ItemType>::RadixType const key =
+                        radix<ItemType, Ascending>(a[item]);
+                for (ssize_t pass = 0; pass < Passes; pass++) {
+                    histograms[pass * Buckets + ((key >> (pass * DigitBits))
+                            & (Buckets - 1))]++;
+                }
+            }
+        }
+
+        /*
+         * items are staged in cache line sized buffers aligned to the
+         * output index space, so every full buffer goes out as one line
+         */
+        template<typename ItemType, typename PayloadType, bool Ascending,
+        bool Payload, ssize_t DigitBits>
+        void scatter(ItemType const * const source,
+                PayloadType const * const sourcePayload,
+                ItemType * const target, PayloadType * const targetPayload,
+                ssize_t const count, ssize_t const shift,
+                ssize_t const * const histogram) {
+            ssize_t constexpr Buckets = 1 << DigitBits;
+            ssize_t constexpr BufferItems = WriteCombiningBytes
+                    / sizeof (ItemType);
+            ssize_t constexpr PayloadBufferItems = Payload ? BufferItems : 1;
+            alignas(WriteCombiningBytes) ItemType buffers[
+                    Buckets * BufferItems];
+            alignas(WriteCombiningBytes) PayloadType payloadBuffers[
+                    Buckets * PayloadBufferItems];
+            ssize_t starts[Buckets];
+            ssize_t positions[Buckets];
+
+            ssize_t sum = 0;
+            for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                starts[bucket] = sum;
+                positions[bucket] = sum;
+                sum += histogram[bucket];
+            }
+
+            for (ssize_t item = 0; item < count; item++) {
+                ssize_t const bucket = (radix<ItemType, Ascending>(
+                        source[item]) >> shift) & (Buckets - 1);
+                ssize_t const position = positions[bucket]++;
+                ssize_t const slot = position & (BufferItems - 1);
+                buffers[bucket * BufferItems + slot] = source[item];
+                if (Payload) {
+                    payloadBuffers[bucket * PayloadBufferItems + slot] =
+                            sourcePayload[item];
+                }
+                if (slot == BufferItems - 1) {
+                    ssize_t const lineStart = std::max(position - slot,
+                            starts[bucket]);
+                    ssize_t const skipped = lineStart - (position - slot);
+                    memcpy(target + lineStart,
+                            buffers + bucket * BufferItems + skipped,
+                            (BufferItems - skipped) * sizeof (ItemType));
+                    if (Payload) {
+                        memcpy(targetPayload + lineStart, payloadBuffers
+                                + bucket * PayloadBufferItems + skipped,
+                                (BufferItems - skipped)
+                                * sizeof (PayloadType));
+                    }
+                }
+            }
+
+            for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                ssize_t const position = positions[bucket];
+                ssize_t const lineStart = std::max(position
+                        & ~(BufferItems - 1), starts[bucket]);
+                ssize_t const skipped = lineStart & (BufferItems - 1);
+                memcpy(target + lineStart,
+                        buffers + bucket * BufferItems + skipped,
+                        (position - lineStart) * sizeof (ItemType));
+                if (Payload) {
+                    memcpy(targetPayload + lineStart, payloadBuffers
+                            + bucket * PayloadBufferItems + skipped,
+                            (position - lineStart) * sizeof (PayloadType));
+                }
+            }
+        }
+
+        template<typename ItemType, typename PayloadType, bool Ascending,
+        bool Payload, ssize_t DigitBits>
+        void radixsort(ItemType * const a, PayloadType * const payload,
+                ssize_t const count, ItemType * const scratchpad,
+                PayloadType * const payloadScratchpad) {
+            ssize_t constexpr Passes = passesCount<ItemType, DigitBits>();
+            ssize_t constexpr Buckets = 1 << DigitBits;
+            if (count < 2) {
+                return;
+            }
+            ssize_t histograms[Passes * Buckets] = {};
+            computeHistograms<ItemType, Ascending, DigitBits>(a, count,
+                    histograms);
+
+            ItemType * source = a;
+            ItemType * target = scratchpad;
+            PayloadType * sourcePayload = payload;
+            PayloadType * targetPayload = payloadScratchpad;
+            typename KeyTraits<ItemType>::RadixType const firstKey =
+                    radix<ItemType, Ascending>(a[0]);
+            for (ssize_t pass = 0; pass < Passes; pass++) {
+                ssize_t const shift = pass * DigitBits;
+                ssize_t const * const histogram = histograms + pass * Buckets;
+                if (histogram[(firstKey >> shift) & (Buckets - 1)] == count) {
+                    continue;
+                }
+                scatter<ItemType, PayloadType, Ascending, Payload, DigitBits>(
+                        source, sourcePayload, target, targetPayload, count,
+                        shift, histogram);
+                std::swap(source, target);
+                std::swap(sourcePayload, targetPayload);
+            }
+            if (source != a) {
+                memcpy(a, source, count * sizeof (ItemType));
+                if (Payload) {
+                    memcpy(payload, sourcePayload,
+                            count * sizeof (PayloadType));
+                }
+            }
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t LsdRadixSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * count;
+    }
+
+    template<typename ItemType, typename PayloadType>
+    ssize_t LsdRadixSortScratchBytes(ssize_t const count) {
+        return keysAndPayloadsScratchBytes<ItemType, PayloadType>(count);
+    }
+
+    /*
+     * scratchpad has to hold count items
+     */
+    template<typename ItemType, bool Ascending = true,
+    ssize_t DigitBits = privateLsdRadixSort::DefaultDigitBits>
+    void LsdRadixSort(ItemType * const a, ssize_t const count,
+            int8_t * const scratchpad) {
+        static_assert(DigitBits >= 8 && DigitBits <= 11,
+                "digit width out of supported range");
+        privateLsdRadixSort::radixsort<ItemType, uint8_t, Ascending, false,
+                DigitBits>(a, nullptr, count, (ItemType *) scratchpad,
+                nullptr);
+    }
+
+    /*
+     * scratchpad has to hold count items, rounded up to a multiple of
+     * 64 bytes, followed by count payloads
+     */
+    template<typename ItemType, typename PayloadType, bool Ascending = true,
+    ssize_t DigitBits = privateLsdRadixSort::DefaultDigitBits>
+    void LsdRadixSort(ItemType * const a, PayloadType * const payload,
+            ssize_t const count, int8_t * const scratchpad) {
+        static_assert(DigitBits >= 8 && DigitBits <= 11,
+                "digit width out of supported range");
+        ssize_t const payloadOffset = payloadScratchOffset<ItemType>(count);
+        privateLsdRadixSort::radixsort<ItemType, PayloadType, Ascending, true,
+                DigitBits>(a, payload, count, (ItemType *) scratchpad,
+                (PayloadType *) (scratchpad + payloadOffset));
+    }
+}
+
+#endif	/* SORTRADIXLSD_HPP */
@@ -0,0 +1,136 @@
+/* 
+ * sortradixmsd.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTRADIXMSD_HPP
+#define	SORTRADIXMSD_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortheaphybridcascading.hpp"
+#include "sortnetworksimd.hpp"
+
+namespace tarsa {
+
+    namespace privateMsdRadixSort {
+
+        using namespace privateRadixSorts;
+
+        ssize_t constexpr DigitBits = 8;
+        ssize_t constexpr Buckets = 1 << DigitBits;
+
+        template<typename ItemType, bool Ascending>
+        ssize_t digit(ItemType const item, ssize_t const shift) {
+            return (radix<ItemType, Ascending>(item) >> shift) & (Buckets - 1);
+        }
+
+        template<typename ItemType, bool Ascending>
+        void sortLeaf(ItemType * const a, ssize_t const count,
+                std::false_type) {
+            if (Ascending) {
+                HybridCascadingHeapSort<ItemType, genericComparisonOperator>(
+                        a, count);
+            } else {
+                HybridCascadingHeapSort<ItemType,
+                        genericReverseComparisonOperator>(a, count);
+            }
+        }
+
+        template<typename ItemType, bool Ascending>
+        void sortLeaf(ItemType * const a, ssize_t const count,
+                std::true_type) {
+            if (count <= SimdSortingNetworkMaxCount<ItemType>()) {
+                SimdSortingNetwork<ItemType, Ascending>(a, count);
+            } else {
+                sortLeaf<ItemType, Ascending>(a, count, std::false_type());
+            }
+        }
+
+        /*
+         * American flag sort: every bucket is filled from its head by
+         * following cycles of misplaced items, so no buffer is needed
+         */
+        template<typename ItemType, bool Ascending, ssize_t LeafThreshold>
+        void radixsort(ItemType * const a, ssize_t const count,
+                ssize_t shift) {
+            if (count <= LeafThreshold) {
+                sortLeaf<ItemType, Ascending>(a, count, std::integral_constant<
+                        bool, std::is_integral<ItemType>::value>());
+                return;
+            }
+            ssize_t heads[Buckets];
+            ssize_t tails[Buckets];
+            while (true) {
+                std::fill(tails, tails + Buckets, 0);
+                for (ssize_t item = 0; item < count; item++) {
+                    tails[digit<ItemType, Ascending>(a[item], shift)]++;
+                }
+                if (tails[digit<ItemType, Ascending>(a[0], shift)] != count) {
+                    break;
+                }
+                if (shift == 0) {
+                    return;
+                }
+                shift -= DigitBits;
+            }
+
+            ssize_t sum = 0;
+            for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                heads[bucket] = sum;
+                sum += tails[bucket];
+                tails[bucket] = sum;
+            }
+
+            for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                while (heads[bucket] < tails[bucket]) {
+                    ItemType item = a[heads[bucket]];
+                    ssize_t itemBucket = digit<ItemType, Ascending>(item,
+                            shift);
+                    while (itemBucket != bucket) {
+                        std::swap(item, a[heads[itemBucket]++]);
+                        itemBucket = digit<ItemType, Ascending>(item, shift);
+                    }
+                    a[heads[bucket]++] = item;
+                }
+            }
+
+            if (shift > 0) {
+                ssize_t start = 0;
+                for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                    radixsort<ItemType, Ascending, LeafThreshold>(a + start,
+                            tails[bucket] - start, shift - DigitBits);
+                    start = tails[bucket];
+                }
+            }
+        }
+    }
+
+    template<typename ItemType, bool Ascending = true,
+    ssize_t LeafThreshold = 64 >
+    void MsdRadixSort(ItemType * const a, ssize_t const count) {
+        static_assert(LeafThreshold >= 1, "leaf threshold has to be positive");
+        privateMsdRadixSort::radixsort<ItemType, Ascending, LeafThreshold>(
+                a, count, sizeof (ItemType) * 8
+                - privateMsdRadixSort::DigitBits);
+    }
+}
+
+#endif	/* SORTRADIXMSD_HPP */
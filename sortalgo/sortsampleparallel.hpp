@@ -0,0 +1,236 @@
+/* 
+ * sortsampleparallel.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTSAMPLEPARALLEL_HPP
+#define	SORTSAMPLEPARALLEL_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortquickpatterndefeating.hpp"
+#include "sortquicksimddword.hpp"
+#include "workstealingpool.hpp"
+
+#include <vector>
+
+namespace tarsa {
+
+    /*
+     * based on: "Super Scalar Sample Sort" and "In-place Parallel Super
+     * Scalar Samplesort (IPS4o)", but distributing through the scratchpad
+     * instead of in place
+     */
+    namespace privateParallelSampleSort {
+
+        ssize_t constexpr LogBuckets = 8;
+        ssize_t constexpr Buckets = 1 << LogBuckets;
+        ssize_t constexpr Oversampling = 16;
+        ssize_t constexpr ParallelThreshold = 1 << 16;
+        ssize_t constexpr StripesPerWorker = 4;
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        struct QuickSortKernel {
+
+            static void sort(ItemType * const a, ssize_t const count) {
+                PatternDefeatingQuickSort<ItemType, compOp>(a, count);
+            }
+        };
+
+        template<typename ItemType>
+        struct SimdQuickSortKernel {
+
+            static void sort(ItemType * const a, ssize_t const count) {
+                SimdDwordQuickSort<ItemType>(a, count);
+            }
+        };
+
+        /*
+         * splitters are stored twice: sorted, for the equality check, and
+         * as an implicit search tree, for the branchless descent
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        struct Classifier {
+            ItemType tree[Buckets];
+            ItemType splitters[Buckets];
+
+            void buildTree(ssize_t const node, ssize_t * const next) {
+                if (node < Buckets) {
+                    buildTree(node * 2, next);
+                    tree[node] = splitters[(*next)++];
+                    buildTree(node * 2 + 1, next);
+                }
+            }
+
+            /*
+             * even bucket 2b holds items between splitters b - 1 and b,
+             * odd bucket 2b + 1 holds items equal to splitter b
+             */
+            ssize_t classify(ItemType const item) const {
+                ssize_t node = 1;
+                for (ssize_t level = 0; level < LogBuckets; level++) {
+                    node = node * 2 + compOp(tree[node], Below, item);
+                }
+                ssize_t const bucket = node - Buckets;
+                return bucket * 2 + ((bucket < Buckets - 1)
+                        & !compOp(item, Below, splitters[bucket]));
+            }
+        };
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Kernel>
+        void sampleSplitters(ItemType const * const a, ssize_t const count,
+                Classifier<ItemType, compOp> * const classifier) {
+            ssize_t constexpr SampleSize = Buckets * Oversampling;
+            ItemType sample[SampleSize];
+            uint64_t state = 0x9e3779b97f4a7c15ull ^ count;
+            for (ssize_t index = 0; index < SampleSize; index++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                sample[index] = a[state % count];
+            }
+            Kernel::sort(sample, SampleSize);
+
+            ssize_t unique = 0;
+            for (ssize_t index = Oversampling; index < SampleSize;
+                    index += Oversampling) {
+                if (unique == 0 || compOp(classifier->splitters[unique - 1],
+                        Below, sample[index])) {
+                    classifier->splitters[unique++] = sample[index];
+                }
+            }
+            std::fill(classifier->splitters + unique,
+                    classifier->splitters + Buckets,
+                    classifier->splitters[unique - 1]);
+            ssize_t next = 0;
+            classifier->buildTree(1, &next);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Kernel>
+        void samplesort(WorkStealingPool &pool, ItemType * const a,
+                ssize_t const count, ItemType * const scratchpad) {
+            if (count < ParallelThreshold || pool.size() == 1) {
+                Kernel::sort(a, count);
+                return;
+            }
+            Classifier<ItemType, compOp> classifier;
+            sampleSplitters<ItemType, compOp, Kernel>(a, count, &classifier);
+
+            ssize_t const stripes = pool.size() * StripesPerWorker;
+            std::vector<ssize_t> offsets(stripes * Buckets * 2);
+            auto const stripeBegin = [&](ssize_t const stripe) {
+                return count * stripe / stripes;
+            };
+
+            pool.parallelFor(0, stripes, 1, [&](ssize_t const first,
+                    ssize_t const last) {
+                for (ssize_t stripe = first; stripe < last; stripe++) {
+                    ssize_t * const histogram = &offsets[stripe * Buckets * 2];
+                    for (ssize_t item = stripeBegin(stripe);
+                            item < stripeBegin(stripe + 1); item++) {
+                        histogram[classifier.classify(a[item])]++;
+                    }
+                }
+            });
+
+            std::vector<ssize_t> bucketStarts(Buckets * 2 + 1);
+            ssize_t sum = 0;
+            for (ssize_t bucket = 0; bucket < Buckets * 2; bucket++) {
+                bucketStarts[bucket] = sum;
+                for (ssize_t stripe = 0; stripe < stripes; stripe++) {
+                    ssize_t &offset = offsets[stripe * Buckets * 2 + bucket];
+                    ssize_t const histogram = offset;
+                    offset = sum;
+                    sum += histogram;
+                }
+            }
+            bucketStarts[Buckets * 2] = sum;
+
+            pool.parallelFor(0, stripes, 1, [&](ssize_t const first,
+                    ssize_t const last) {
+                for (ssize_t stripe = first; stripe < last; stripe++) {
+                    ssize_t * const positions = &offsets[stripe * Buckets * 2];
+                    for (ssize_t item = stripeBegin(stripe);
+                            item < stripeBegin(stripe + 1); item++) {
+                        scratchpad[positions[classifier.classify(a[item])]++]
+                                = a[item];
+                    }
+                }
+            });
+
+            // buckets are copied back and sorted independently, equality
+            // buckets are already sorted and skewed buckets recurse
+            pool.parallelFor(0, Buckets * 2, 1, [&](ssize_t const first,
+                    ssize_t const last) {
+                for (ssize_t bucket = first; bucket < last; bucket++) {
+                    ssize_t const begin = bucketStarts[bucket];
+                    ssize_t const end = bucketStarts[bucket + 1];
+                    std::copy(scratchpad + begin, scratchpad + end, a + begin);
+                    if (bucket % 2 == 1) {
+                        continue;
+                    }
+                    if ((end - begin) * pool.size() > count) {
+                        samplesort<ItemType, compOp, Kernel>(pool, a + begin,
+                                end - begin, scratchpad + begin);
+                    } else {
+                        Kernel::sort(a + begin, end - begin);
+                    }
+                }
+            });
+        }
+    }
+
+    template<typename ItemType>
+    ssize_t ParallelSampleSortScratchBytes(ssize_t const count) {
+        return sizeof (ItemType) * count;
+    }
+
+    /*
+     * scratchpad has to hold count items, has to be called from inside
+     * pool.run()
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void ParallelSampleSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        privateParallelSampleSort::samplesort<ItemType, compOp,
+                privateParallelSampleSort::QuickSortKernel<ItemType, compOp> >(
+                pool, a, count, (ItemType *) scratchpad);
+    }
+
+    /*
+     * dword keys are finished with the SIMD quicksort
+     */
+    template<typename ItemType>
+    void ParallelSampleSort(WorkStealingPool &pool, ItemType * const a,
+            ssize_t const count, int8_t * const scratchpad) {
+        bool constexpr dword = std::is_same<ItemType, int32_t>::value
+                || std::is_same<ItemType, uint32_t>::value;
+        privateParallelSampleSort::samplesort<ItemType,
+                genericComparisonOperator, typename std::conditional<dword,
+                privateParallelSampleSort::SimdQuickSortKernel<ItemType>,
+                privateParallelSampleSort::QuickSortKernel<ItemType,
+                genericComparisonOperator> >::type>(
+                pool, a, count, (ItemType *) scratchpad);
+    }
+}
+
+#endif	/* SORTSAMPLEPARALLEL_HPP */
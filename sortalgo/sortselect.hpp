@@ -0,0 +1,237 @@
+/* 
+ * sortselect.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTSELECT_HPP
+#define	SORTSELECT_HPP
+
+#include "sortalgocommon.hpp"
+#include "sortnetworksimd.hpp"
+#include "sortpartial.hpp"
+#include "sortquicksimddword.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+namespace tarsa {
+
+    /*
+     * based on: "Expected Time Bounds for Selection" by Floyd and Rivest;
+     * every round partitions around a pivot picked from a sample sized so
+     * the k-th item most likely falls into a small part, runs of copies of
+     * the pivot are split off by a second pass, so they never stall the
+     * loop; after too many rounds a heap select finishes the job
+     */
+    namespace privateSelect {
+
+        ssize_t constexpr SampleThreshold = 600;
+        ssize_t constexpr ScalarSmallThreshold = 16;
+
+        /*
+         * the Hoare loop of RandomizedQuickSort, driven by a predicate, so
+         * the same loop gives [< pivot, >= pivot) and [<= pivot, > pivot)
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        struct ScalarPartitioner {
+            static ssize_t constexpr SmallThreshold = ScalarSmallThreshold;
+
+            template<bool PivotGoesLeft>
+            static bool goesRight(ItemType const item, ItemType const pivot) {
+                return PivotGoesLeft ? compOp(pivot, Below, item)
+                        : !compOp(item, Below, pivot);
+            }
+
+            template<bool PivotGoesLeft>
+            static ssize_t partition(ItemType * const a, ssize_t const left,
+                    ssize_t const right, ItemType const pivot) {
+                ssize_t i = left;
+                ssize_t j = right - 1;
+                while (true) {
+                    while (i <= j && !goesRight<PivotGoesLeft>(a[i], pivot)) {
+                        i++;
+                    }
+                    while (i <= j && goesRight<PivotGoesLeft>(a[j], pivot)) {
+                        j--;
+                    }
+                    if (i >= j) {
+                        return i;
+                    }
+                    std::swap(a[i], a[j]);
+                    i++;
+                    j--;
+                }
+            }
+
+            static void sortSmall(ItemType * const a, ssize_t const count) {
+                for (ssize_t item = 1; item < count; item++) {
+                    ItemType const value = a[item];
+                    ssize_t hole = item;
+                    while (hole > 0 && compOp(value, Below, a[hole - 1])) {
+                        a[hole] = a[hole - 1];
+                        hole--;
+                    }
+                    a[hole] = value;
+                }
+            }
+        };
+
+        template<typename ItemType, bool Ascending>
+        struct SimdDwordPartitioner {
+            static ssize_t constexpr SmallThreshold =
+                    SimdSortingNetworkMaxCount<ItemType>();
+
+            template<bool PivotGoesLeft>
+            static ssize_t partition(ItemType * const a, ssize_t const left,
+                    ssize_t const right, ItemType const pivot) {
+                if (right - left < privateSimdDwordQuickSort::VectorSize * 2) {
+                    return std::conditional<Ascending,
+                            ScalarPartitioner<ItemType,
+                            genericComparisonOperator>,
+                            ScalarPartitioner<ItemType,
+                            genericReverseComparisonOperator> >::type::
+                            template partition<PivotGoesLeft>(a, left, right,
+                            pivot);
+                }
+                return privateSimdDwordQuickSort::partition<ItemType,
+                        std::is_same<ItemType, int32_t>::value, Ascending,
+                        PivotGoesLeft>(a, left, right, pivot);
+            }
+
+            static void sortSmall(ItemType * const a, ssize_t const count) {
+                SimdSortingNetwork<ItemType, Ascending>(a, count);
+            }
+        };
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        ItemType medianOf3(ItemType const x, ItemType const y,
+                ItemType const z) {
+            if (compOp(x, Below, y)) {
+                return compOp(y, Below, z) ? y : compOp(x, Below, z) ? z : x;
+            } else {
+                return compOp(x, Below, z) ? x : compOp(y, Below, z) ? z : y;
+            }
+        }
+
+        /*
+         * the k-th item of [left, right) after a heap select; guaranteed
+         * O(n log n)
+         */
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        void heapSelect(ItemType * const a, ssize_t const left,
+                ssize_t const right, ssize_t const k) {
+            privatePartialSort::partialSort<ItemType, compOp,
+                    privatePartialSort::reversed<ItemType, compOp>,
+                    QuaternaryHeapLayout>(a + left, right - left,
+                    k - left + 1);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Partitioner>
+        void select(ItemType * const a, ssize_t left, ssize_t right,
+                ssize_t const k, ssize_t depthLimit) {
+            while (right - left > Partitioner::SmallThreshold) {
+                if (depthLimit-- == 0) {
+                    heapSelect<ItemType, compOp>(a, left, right, k);
+                    return;
+                }
+                ssize_t const count = right - left;
+                ItemType pivot;
+                if (count > SampleThreshold) {
+                    // the sample range is chosen so that its k-th item is
+                    // a close upper or lower bound of the one sought
+                    double const rank = k - left + 1;
+                    double const logCount = std::log(count);
+                    double const sample = 0.5 * std::exp(logCount * 2 / 3);
+                    double const deviation = 0.5 * std::sqrt(logCount * sample
+                            * (count - sample) / count)
+                            * (rank < count / 2 ? -1 : 1);
+                    ssize_t const sampleLeft = std::max(left, std::min(k,
+                            (ssize_t) (k - rank * sample / count
+                            + deviation)));
+                    ssize_t const sampleRight = std::min(right, std::max(k,
+                            (ssize_t) (k + (count - rank) * sample / count
+                            + deviation)) + 1);
+                    select<ItemType, compOp, Partitioner>(a, sampleLeft,
+                            sampleRight, k, depthLimit);
+                    pivot = a[k];
+                } else {
+                    pivot = medianOf3<ItemType, compOp>(a[left],
+                            a[left + count / 2], a[right - 1]);
+                }
+                ssize_t const middle = Partitioner::template partition<false>(
+                        a, left, right, pivot);
+                if (k < middle) {
+                    right = middle;
+                    continue;
+                }
+                ssize_t const equalEnd = Partitioner::template partition<true>(
+                        a, middle, right, pivot);
+                if (k < equalEnd) {
+                    return;
+                }
+                left = equalEnd;
+            }
+            Partitioner::sortSmall(a + left, right - left);
+        }
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp,
+        typename Partitioner>
+        void nthElement(ItemType * const a, ssize_t const count,
+                ssize_t const k) {
+            if (k < 0 || k >= count) {
+                return;
+            }
+            ssize_t depthLimit = 0;
+            for (ssize_t remaining = count; remaining > 1; remaining >>= 1) {
+                depthLimit += 2;
+            }
+            select<ItemType, compOp, Partitioner>(a, 0, count, k, depthLimit);
+        }
+    }
+
+    /*
+     * puts the item of rank k at a[k], with no item Above it before and no
+     * item Below it after, like std::nth_element
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp>
+    void NthElement(ItemType * const a, ssize_t const count, ssize_t const k) {
+        privateSelect::nthElement<ItemType, compOp,
+                privateSelect::ScalarPartitioner<ItemType, compOp> >(
+                a, count, k);
+    }
+
+    /*
+     * dword items are partitioned with AVX2
+     */
+    template<typename ItemType>
+    void NthElement(ItemType * const a, ssize_t const count, ssize_t const k) {
+        bool constexpr dword = std::is_same<ItemType, int32_t>::value
+                || std::is_same<ItemType, uint32_t>::value;
+        privateSelect::nthElement<ItemType, genericComparisonOperator,
+                typename std::conditional<dword,
+                privateSelect::SimdDwordPartitioner<ItemType, true>,
+                privateSelect::ScalarPartitioner<ItemType,
+                genericComparisonOperator> >::type>(a, count, k);
+    }
+}
+
+#endif	/* SORTSELECT_HPP */
@@ -0,0 +1,322 @@
+/* 
+ * sortstableparallel.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef SORTSTABLEPARALLEL_HPP
+#define	SORTSTABLEPARALLEL_HPP
+
+#include "sortalgocommon.hpp"
+#include "workstealingpool.hpp"
+
+#include <vector>
+
+namespace tarsa {
+
+    /*
+     * keys and payloads live in separate arrays, like in LsdRadixSort, and
+     * every move applies to both; the scratchpad holds count keys, rounded
+     * up to a multiple of 64 bytes, followed by count payloads
+     */
+    namespace privateParallelStableSort {
+
+        ssize_t constexpr InsertionSortBlock = 32;
+        ssize_t constexpr MergeGrain = InsertionSortBlock << 10;
+        ssize_t constexpr StripesPerWorker = 4;
+        ssize_t constexpr ParallelThreshold = 1 << 14;
+
+        template<typename KeyType, typename PayloadType>
+        void copyRange(KeyType const * const keys,
+                PayloadType const * const payload, ssize_t const begin,
+                ssize_t const end, KeyType * const targetKeys,
+                PayloadType * const targetPayload) {
+            std::copy(keys + begin, keys + end, targetKeys + begin);
+            std::copy(payload + begin, payload + end, targetPayload + begin);
+        }
+
+        template<typename KeyType, typename PayloadType,
+        ComparisonOperator<KeyType> compOp>
+        void insertionSort(KeyType * const keys, PayloadType * const payload,
+                ssize_t const begin, ssize_t const end) {
+            for (ssize_t item = begin + 1; item < end; item++) {
+                KeyType const key = keys[item];
+                PayloadType const value = payload[item];
+                ssize_t hole = item;
+                while (hole > begin && compOp(key, Below, keys[hole - 1])) {
+                    keys[hole] = keys[hole - 1];
+                    payload[hole] = payload[hole - 1];
+                    hole--;
+                }
+                keys[hole] = key;
+                payload[hole] = value;
+            }
+        }
+
+        /*
+         * number of items taken from the left run among the first rank
+         * items of the stable merge of both runs
+         */
+        template<typename KeyType, ComparisonOperator<KeyType> compOp>
+        ssize_t coRank(ssize_t const rank, KeyType const * const left,
+                ssize_t const leftCount, KeyType const * const right,
+                ssize_t const rightCount) {
+            ssize_t low = std::max((ssize_t) 0, rank - rightCount);
+            ssize_t high = std::min(rank, leftCount);
+            while (low < high) {
+                ssize_t const taken = low + (high - low) / 2;
+                // equal keys go to the left run first
+                if (compOp(right[rank - taken - 1], Below, left[taken])) {
+                    high = taken;
+                } else {
+                    low = taken + 1;
+                }
+            }
+            return low;
+        }
+
+        /*
+         * writes items [first, last) of the stable merge of both runs to
+         * the target, starting at target index first
+         */
+        template<typename KeyType, typename PayloadType,
+        ComparisonOperator<KeyType> compOp>
+        void mergeSlice(KeyType const * const keys,
+                PayloadType const * const payload, ssize_t const leftBegin,
+                ssize_t const rightBegin, ssize_t const rightEnd,
+                ssize_t const first, ssize_t const last,
+                KeyType * const targetKeys,
+                PayloadType * const targetPayload) {
+            ssize_t const leftCount = rightBegin - leftBegin;
+            ssize_t const rightCount = rightEnd - rightBegin;
+            ssize_t const leftTaken = coRank<KeyType, compOp>(first - leftBegin,
+                    keys + leftBegin, leftCount, keys + rightBegin,
+                    rightCount);
+            ssize_t left = leftBegin + leftTaken;
+            ssize_t right = rightBegin + (first - leftBegin - leftTaken);
+            for (ssize_t target = first; target < last; target++) {
+                bool const takeLeft = right == rightEnd || (left < rightBegin
+                        && !compOp(keys[right], Below, keys[left]));
+                ssize_t const source = takeLeft ? left++ : right++;
+                targetKeys[target] = keys[source];
+                targetPayload[target] = payload[source];
+            }
+        }
+
+        /*
+         * sorts the blocks in place, then merges runs bottom up between the
+         * arrays and the scratchpad; slices of a bounded size are merged
+         * independently, so the last levels keep every worker busy too
+         */
+        template<typename KeyType, typename PayloadType,
+        ComparisonOperator<KeyType> compOp>
+        void mergesort(WorkStealingPool &pool, KeyType * const keys,
+                PayloadType * const payload, ssize_t const count,
+                KeyType * const scratchKeys,
+                PayloadType * const scratchPayload) {
+            ssize_t const blocks = (count + InsertionSortBlock - 1)
+                    / InsertionSortBlock;
+            pool.parallelFor(0, blocks, MergeGrain / InsertionSortBlock,
+                    [&](ssize_t const first, ssize_t const last) {
+                        for (ssize_t block = first; block < last; block++) {
+                            insertionSort<KeyType, PayloadType, compOp>(keys,
+                                    payload, block * InsertionSortBlock,
+                                    std::min(count, (block + 1)
+                                    * InsertionSortBlock));
+                        }
+                    });
+
+            KeyType * sourceKeys = keys;
+            PayloadType * sourcePayload = payload;
+            KeyType * targetKeys = scratchKeys;
+            PayloadType * targetPayload = scratchPayload;
+            for (ssize_t width = InsertionSortBlock; width < count;
+                    width *= 2) {
+                // both are powers of two, so no slice spans two pairs
+                ssize_t const grain = std::min(width * 2, MergeGrain);
+                ssize_t const slices = (count + grain - 1) / grain;
+                pool.parallelFor(0, slices, 1, [&](ssize_t const first,
+                        ssize_t const last) {
+                    for (ssize_t slice = first; slice < last; slice++) {
+                        ssize_t const begin = slice * grain;
+                        ssize_t const pairBegin = begin / (width * 2)
+                                * (width * 2);
+                        ssize_t const middle = std::min(count,
+                                pairBegin + width);
+                        ssize_t const pairEnd = std::min(count,
+                                pairBegin + width * 2);
+                        mergeSlice<KeyType, PayloadType, compOp>(sourceKeys,
+                                sourcePayload, pairBegin, middle, pairEnd,
+                                begin, std::min(begin + grain, count),
+                                targetKeys, targetPayload);
+                    }
+                });
+                std::swap(sourceKeys, targetKeys);
+                std::swap(sourcePayload, targetPayload);
+            }
+            if (sourceKeys != keys) {
+                pool.parallelFor(0, count, MergeGrain, [&](ssize_t const first,
+                        ssize_t const last) {
+                    copyRange(sourceKeys, sourcePayload, first, last, keys,
+                            payload);
+                });
+            }
+        }
+
+        /*
+         * every pass classifies the stripes in parallel and gives each
+         * stripe its own range in every bucket, in stripe order, so equal
+         * digits keep their relative order
+         */
+        template<typename KeyType, typename PayloadType, bool Ascending,
+        ssize_t DigitBits>
+        void radixsort(WorkStealingPool &pool, KeyType * const keys,
+                PayloadType * const payload, ssize_t const count,
+                KeyType * const scratchKeys,
+                PayloadType * const scratchPayload) {
+            using namespace privateRadixSorts;
+            ssize_t constexpr Buckets = 1 << DigitBits;
+            ssize_t constexpr Passes = (sizeof (KeyType) * 8 + DigitBits - 1)
+                    / DigitBits;
+            ssize_t const stripes = count < ParallelThreshold
+                    ? 1 : pool.size() * StripesPerWorker;
+            auto const stripeBegin = [&](ssize_t const stripe) {
+                return count * stripe / stripes;
+            };
+            std::vector<ssize_t> offsets(stripes * Buckets);
+
+            KeyType * sourceKeys = keys;
+            PayloadType * sourcePayload = payload;
+            KeyType * targetKeys = scratchKeys;
+            PayloadType * targetPayload = scratchPayload;
+            for (ssize_t pass = 0; pass < Passes; pass++) {
+                ssize_t const shift = pass * DigitBits;
+                auto const digit = [&](KeyType const key) {
+                    return (radix<KeyType, Ascending>(key) >> shift)
+                            & (Buckets - 1);
+                };
+                std::fill(offsets.begin(), offsets.end(), 0);
+                pool.parallelFor(0, stripes, 1, [&](ssize_t const first,
+                        ssize_t const last) {
+                    for (ssize_t stripe = first; stripe < last; stripe++) {
+                        ssize_t * const histogram = &offsets[stripe * Buckets];
+                        for (ssize_t item = stripeBegin(stripe);
+                                item < stripeBegin(stripe + 1); item++) {
+                            histogram[digit(sourceKeys[item])]++;
+                        }
+                    }
+                });
+
+                ssize_t sum = 0;
+                bool trivial = false;
+                for (ssize_t bucket = 0; bucket < Buckets; bucket++) {
+                    ssize_t const bucketStart = sum;
+                    for (ssize_t stripe = 0; stripe < stripes; stripe++) {
+                        ssize_t &offset = offsets[stripe * Buckets + bucket];
+                        ssize_t const histogram = offset;
+                        offset = sum;
+                        sum += histogram;
+                    }
+                    trivial |= sum - bucketStart == count;
+                }
+                if (trivial) {
+                    continue;
+                }
+
+                pool.parallelFor(0, stripes, 1, [&](ssize_t const first,
+                        ssize_t const last) {
+                    for (ssize_t stripe = first; stripe < last; stripe++) {
+                        ssize_t * const positions = &offsets[stripe * Buckets];
+                        for (ssize_t item = stripeBegin(stripe);
+                                item < stripeBegin(stripe + 1); item++) {
+                            ssize_t const position =
+                                    positions[digit(sourceKeys[item])]++;
+                            targetKeys[position] = sourceKeys[item];
+                            targetPayload[position] = sourcePayload[item];
+                        }
+                    }
+                });
+                std::swap(sourceKeys, targetKeys);
+                std::swap(sourcePayload, targetPayload);
+            }
+            if (sourceKeys != keys) {
+                pool.parallelFor(0, count, MergeGrain, [&](ssize_t const first,
+                        ssize_t const last) {
+                    copyRange(sourceKeys, sourcePayload, first, last, keys,
+                            payload);
+                });
+            }
+        }
+    }
+
+    template<typename KeyType, typename PayloadType>
+    ssize_t ParallelStableMergeSortScratchBytes(ssize_t const count) {
+        return keysAndPayloadsScratchBytes<KeyType, PayloadType>(count);
+    }
+
+    template<typename KeyType, typename PayloadType>
+    ssize_t ParallelStableRadixSortScratchBytes(ssize_t const count) {
+        return keysAndPayloadsScratchBytes<KeyType, PayloadType>(count);
+    }
+
+    /*
+     * stable; scratchpad has to hold count keys, rounded up to a multiple
+     * of 64 bytes, followed by count payloads; has to be called from inside
+     * pool.run()
+     */
+    template<typename KeyType, typename PayloadType,
+    ComparisonOperator<KeyType> compOp>
+    void ParallelStableMergeSort(WorkStealingPool &pool, KeyType * const keys,
+            PayloadType * const payload, ssize_t const count,
+            int8_t * const scratchpad) {
+        ssize_t const payloadOffset = payloadScratchOffset<KeyType>(count);
+        privateParallelStableSort::mergesort<KeyType, PayloadType, compOp>(
+                pool, keys, payload, count, (KeyType *) scratchpad,
+                (PayloadType *) (scratchpad + payloadOffset));
+    }
+
+    template<typename KeyType, typename PayloadType>
+    void ParallelStableMergeSort(WorkStealingPool &pool, KeyType * const keys,
+            PayloadType * const payload, ssize_t const count,
+            int8_t * const scratchpad) {
+        ParallelStableMergeSort<KeyType, PayloadType,
+                genericComparisonOperator>(pool, keys, payload, count,
+                scratchpad);
+    }
+
+    /*
+     * stable, same scratchpad layout as ParallelStableMergeSort; has to be
+     * called from inside pool.run()
+     */
+    template<typename KeyType, typename PayloadType, bool Ascending = true,
+    ssize_t DigitBits = 8 >
+    void ParallelStableRadixSort(WorkStealingPool &pool, KeyType * const keys,
+            PayloadType * const payload, ssize_t const count,
+            int8_t * const scratchpad) {
+        static_assert(DigitBits >= 8 && DigitBits <= 11,
+                "digit width out of supported range");
+        ssize_t const payloadOffset = payloadScratchOffset<KeyType>(count);
+        privateParallelStableSort::radixsort<KeyType, PayloadType, Ascending,
+                DigitBits>(pool, keys, payload, count, (KeyType *) scratchpad,
+                (PayloadType *) (scratchpad + payloadOffset));
+    }
+}
+
+#endif	/* SORTSTABLEPARALLEL_HPP */
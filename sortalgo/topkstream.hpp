@@ -0,0 +1,170 @@
+/* 
+ * topkstream.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef TOPKSTREAM_HPP
+#define	TOPKSTREAM_HPP
+
+#include "priorityqueue.hpp"
+#include "sortalgocommon.hpp"
+#include "sortpartial.hpp"
+#include "sortquicksimddword.hpp"
+
+#include <cstdlib>
+#include <type_traits>
+
+namespace tarsa {
+
+    namespace privateStreamingTopK {
+
+        template<typename ItemType, ComparisonOperator<ItemType> compOp>
+        struct ScalarFilter {
+
+            /*
+             * index of the first item Below the threshold, or end
+             */
+            static ssize_t firstCandidate(ItemType const * const items,
+                    ssize_t item, ssize_t const end,
+                    ItemType const threshold) {
+                while (item < end && !compOp(items[item], Below, threshold)) {
+                    item++;
+                }
+                return item;
+            }
+        };
+
+        /*
+         * compares eight items at once, so rejected items never leave the
+         * vector registers
+         */
+        template<typename ItemType, bool Ascending>
+        struct SimdDwordFilter {
+
+            static ssize_t firstCandidate(ItemType const * const items,
+                    ssize_t item, ssize_t const end,
+                    ItemType const threshold) {
+                using namespace privateSimdDwordQuickSort;
+                __m256i const limit = _mm256_set1_epi32(threshold);
+                for (; item + VectorSize <= end; item += VectorSize) {
+                    __m256i const vector = _mm256_loadu_si256(
+                            (__m256i const *) (items + item));
+                    int const mask = _mm256_movemask_ps(_mm256_castsi256_ps(
+                            verticalOrdered<std::is_same<ItemType,
+                            int32_t>::value, Ascending>(vector, limit)));
+                    if (mask != 0) {
+                        return item + __builtin_ctz(mask);
+                    }
+                }
+                while (item < end && !ordered<ItemType, Ascending>(
+                        items[item], threshold)) {
+                    item++;
+                }
+                return item;
+            }
+        };
+    }
+
+    /*
+     * keeps the k items Below all others pushed so far in a bounded heap;
+     * once the heap is full the filter skips every item not Below its
+     * leader, so only the few survivors pay for a sift-down
+     */
+    template<typename ItemType, ComparisonOperator<ItemType> compOp,
+    typename Layout = QuaternaryHeapLayout,
+    typename Filter = privateStreamingTopK::ScalarFilter<ItemType, compOp> >
+    class StreamingTopK {
+        ItemType * heap;
+        ssize_t k;
+        ssize_t count;
+        ssize_t top;
+
+    public:
+
+        StreamingTopK(ssize_t const k) : k(k), count(0), top(0) {
+            heap = allocateAligned<ItemType>(std::max(k, (ssize_t) 1));
+        }
+
+        ~StreamingTopK() {
+            free(heap);
+        }
+
+        StreamingTopK(StreamingTopK const &) = delete;
+        StreamingTopK & operator=(StreamingTopK const &) = delete;
+
+        ssize_t size() const {
+            return count;
+        }
+
+        void push(ItemType const * const items, ssize_t const itemsCount) {
+            using namespace privatePartialSort;
+            ssize_t item = std::min(k - count, itemsCount);
+            if (item > 0) {
+                std::copy(items, items + item, heap + count);
+                count += item;
+                if (count == k) {
+                    heapify<ItemType, compOp, Layout>(heap, k);
+                    top = Layout::template leader<ItemType, compOp>(heap, 0,
+                            k);
+                }
+            }
+            if (count < k || k == 0) {
+                return;
+            }
+            while (true) {
+                item = Filter::firstCandidate(items, item, itemsCount,
+                        heap[top]);
+                if (item == itemsCount) {
+                    return;
+                }
+                heap[top] = items[item++];
+                siftDown<ItemType, compOp, Layout>(heap, k, top);
+                top = Layout::template leader<ItemType, compOp>(heap, 0, k);
+            }
+        }
+
+        /*
+         * writes the kept items to out, sorted, and starts a new stream
+         */
+        void drain(ItemType * const out) {
+            using namespace privatePartialSort;
+            if (count < k) {
+                heapify<ItemType, compOp, Layout>(heap, count);
+            }
+            drainHeap<ItemType, compOp, Layout>(heap, count, count);
+            std::copy(heap, heap + count, out);
+            count = 0;
+        }
+    };
+
+    /*
+     * dword items are filtered with AVX2 and kept in the SIMD heap
+     */
+    template<typename ItemType>
+    using DefaultStreamingTopK = typename std::conditional<
+    std::is_same<ItemType, int32_t>::value
+    || std::is_same<ItemType, uint32_t>::value,
+    StreamingTopK<ItemType, genericComparisonOperator, SimdDwordHeapLayout,
+    privateStreamingTopK::SimdDwordFilter<ItemType, true> >,
+    StreamingTopK<ItemType, genericComparisonOperator> >::type;
+}
+
+#endif	/* TOPKSTREAM_HPP */
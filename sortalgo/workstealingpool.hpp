@@ -0,0 +1,507 @@
+/* 
+ * workstealingpool.hpp -- sorting algorithms benchmark
+ * 
+ * Copyright (C) 2014 Piotr Tarsa ( http://github.com/tarsa )
+ *
+ *  This software is provided 'as-is', without any express or implied
+ *  warranty.  In no event will the author be held liable for any damages
+ *  arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose,
+ *  including commercial applications, and to alter it and redistribute it
+ *  freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not
+ *     claim that you wrote the original software. If you use this software
+ *     in a product, an acknowledgment in the product documentation would be
+ *     appreciated but is not required.
+ *  2. Altered source versions must be plainly marked as such, and must not be
+ *     misrepresented as being the original software.
+ *  3. This notice may not be removed or altered from any source distribution.
+ * 
+ */
+
+#ifndef WORKSTEALINGPOOL_HPP
+#define	WORKSTEALINGPOOL_HPP
+
+#include "numatopology.hpp"
+#include "sortalgocommon.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <x86intrin.h>
+
+namespace tarsa {
+
+    class WorkStealingPool;
+
+    namespace privateWorkStealingPool {
+
+        ssize_t constexpr InitialDequeCapacity = 256;
+        ssize_t constexpr SpinRounds = 64;
+        ssize_t constexpr YieldRounds = 16;
+        ssize_t constexpr CacheLineSize = 64;
+
+        struct Task {
+            std::atomic<ssize_t> * pending;
+
+            virtual void execute() = 0;
+
+            virtual ~Task() {
+            }
+        };
+
+        template<typename Function>
+        struct FunctionTask : Task {
+            Function function;
+
+            FunctionTask(Function const &function) : function(function) {
+            }
+
+            void execute() override {
+                function();
+            }
+        };
+
+        /*
+         * based on: "Correct and Efficient Work-Stealing for Weak Memory
+         * Models", the owner pushes and takes at the bottom, thieves steal
+         * from the top; outgrown buffers are kept until destruction since
+         * a thief can still read from them
+         */
+        class ChaseLevDeque {
+            struct Buffer {
+                ssize_t const capacity;
+                std::atomic<Task *> * const items;
+                Buffer * const previous;
+
+                Buffer(ssize_t const capacity, Buffer * const previous)
+                : capacity(capacity),
+                items(new std::atomic<Task *>[capacity]),
+                previous(previous) {
+                }
+
+                ~Buffer() {
+                    delete[] items;
+                }
+
+                Task * get(ssize_t const index) const {
+                    return items[index & (capacity - 1)].load(
+                            std::memory_order_relaxed);
+                }
+
+                void put(ssize_t const index, Task * const task) {
+                    items[index & (capacity - 1)].store(task,
+                            std::memory_order_relaxed);
+                }
+            };
+
+            // thieves hammer top, the owner mostly touches bottom
+            std::atomic<ssize_t> top;
+            int8_t padding[CacheLineSize];
+            std::atomic<ssize_t> bottom;
+            std::atomic<Buffer *> buffer;
+
+        public:
+
+            ChaseLevDeque() : top(0), bottom(0),
+            buffer(new Buffer(InitialDequeCapacity, nullptr)) {
+            }
+
+            ~ChaseLevDeque() {
+                Buffer * current = buffer.load(std::memory_order_relaxed);
+                while (current != nullptr) {
+                    Buffer * const previous = current->previous;
+                    delete current;
+                    current = previous;
+                }
+            }
+
+            void push(Task * const task) {
+                ssize_t const b = bottom.load(std::memory_order_relaxed);
+                ssize_t const t = top.load(std::memory_order_acquire);
+                Buffer * a = buffer.load(std::memory_order_relaxed);
+                if (b - t > a->capacity - 1) {
+                    Buffer * const grown = new Buffer(a->capacity * 2, a);
+                    for (ssize_t index = t; index < b; index++) {
+                        grown->put(index, a->get(index));
+                    }
+                    buffer.store(grown, std::memory_order_release);
+                    a = grown;
+                }
+                a->put(b, task);
+                bottom.store(b + 1, std::memory_order_release);
+            }
+
+            Task * take() {
+                ssize_t const b = bottom.load(std::memory_order_relaxed) - 1;
+                Buffer * const a = buffer.load(std::memory_order_relaxed);
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                ssize_t t = top.load(std::memory_order_relaxed);
+                if (t > b) {
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                Task * task = a->get(b);
+                if (t == b) {
+                    if (!top.compare_exchange_strong(t, t + 1,
+                            std::memory_order_seq_cst,
+                            std::memory_order_relaxed)) {
+                        task = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return task;
+            }
+
+            Task * steal() {
+                ssize_t t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                ssize_t const b = bottom.load(std::memory_order_acquire);
+                if (t >= b) {
+                    return nullptr;
+                }
+                Buffer * const a = buffer.load(std::memory_order_acquire);
+                Task * const task = a->get(t);
+                if (!top.compare_exchange_strong(t, t + 1,
+                        std::memory_order_seq_cst,
+                        std::memory_order_relaxed)) {
+                    return nullptr;
+                }
+                return task;
+            }
+        };
+
+        /*
+         * the mailbox holds a task that only this worker may run
+         */
+        struct Worker {
+            ChaseLevDeque deque;
+            std::atomic<Task *> mailbox;
+            uint64_t randomState;
+            int8_t padding[CacheLineSize];
+        };
+
+        struct CurrentWorker {
+            WorkStealingPool * pool;
+            ssize_t index;
+        };
+
+        thread_local CurrentWorker currentWorker = {nullptr, 0};
+    }
+
+    /*
+     * fork/join scheduler shared by the parallel sorts; the thread calling
+     * run() acts as worker 0, the remaining workers are owned by the pool,
+     * spin for a while when out of work and then park; a pinning pool pins
+     * the constructing thread as worker 0 and gives it back its previous
+     * affinity on destruction, so it has to be destroyed by that thread
+     */
+    class WorkStealingPool {
+        typedef privateWorkStealingPool::Task Task;
+        typedef privateWorkStealingPool::Worker Worker;
+
+        ssize_t const workersCount;
+        std::vector<Worker> workers;
+        std::vector<std::thread> threads;
+        std::mutex parkingMutex;
+        std::condition_variable parkingCondition;
+        std::atomic<ssize_t> sleepers;
+        std::atomic<ssize_t> epoch;
+        std::atomic<bool> shutdown;
+        bool const pinned;
+        cpu_set_t callerCpus;
+
+        static void pin(pthread_t const thread, ssize_t const index) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(numaTopology().slotCpu(index), &cpus);
+            pthread_setaffinity_np(thread, sizeof (cpu_set_t), &cpus);
+        }
+
+        Task * takeMail(ssize_t const index) {
+            std::atomic<Task *> &mailbox = workers[index].mailbox;
+            return mailbox.load(std::memory_order_relaxed) == nullptr
+                    ? nullptr
+                    : mailbox.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        Task * findTask(ssize_t const index) {
+            Task * const mail = takeMail(index);
+            if (mail != nullptr) {
+                return mail;
+            }
+            Task * const task = workers[index].deque.take();
+            if (task != nullptr || workersCount == 1) {
+                return task;
+            }
+            uint64_t &state = workers[index].randomState;
+            for (ssize_t attempt = 0; attempt < workersCount; attempt++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                ssize_t const victim = state % workersCount;
+                if (victim != index) {
+                    Task * const stolen = workers[victim].deque.steal();
+                    if (stolen != nullptr) {
+                        return stolen;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        Task * scanAll(ssize_t const index) {
+            Task * const mail = workers[index].mailbox.exchange(nullptr,
+                    std::memory_order_seq_cst);
+            if (mail != nullptr) {
+                return mail;
+            }
+            for (ssize_t victim = 0; victim < workersCount; victim++) {
+                Task * const task = victim == index
+                        ? workers[victim].deque.take()
+                        : workers[victim].deque.steal();
+                if (task != nullptr) {
+                    return task;
+                }
+            }
+            return nullptr;
+        }
+
+        static void execute(Task * const task) {
+            std::atomic<ssize_t> * const pending = task->pending;
+            task->execute();
+            delete task;
+            pending->fetch_sub(1, std::memory_order_release);
+        }
+
+        void workerLoop(ssize_t const index) {
+            privateWorkStealingPool::currentWorker = {this, index};
+            ssize_t idleRounds = 0;
+            while (!shutdown.load(std::memory_order_acquire)) {
+                Task * task = findTask(index);
+                if (task != nullptr) {
+                    execute(task);
+                    idleRounds = 0;
+                } else if (idleRounds < privateWorkStealingPool::SpinRounds) {
+                    _mm_pause();
+                    idleRounds++;
+                } else if (idleRounds < privateWorkStealingPool::SpinRounds
+                        + privateWorkStealingPool::YieldRounds) {
+                    std::this_thread::yield();
+                    idleRounds++;
+                } else {
+                    // announce before the final scan, so that a concurrent
+                    // spawn either is seen here or wakes this worker up
+                    sleepers.fetch_add(1, std::memory_order_seq_cst);
+                    ssize_t const observedEpoch = epoch.load(
+                            std::memory_order_seq_cst);
+                    task = scanAll(index);
+                    if (task == nullptr) {
+                        std::unique_lock<std::mutex> lock(parkingMutex);
+                        parkingCondition.wait(lock, [&]() {
+                            return epoch.load(std::memory_order_relaxed)
+                                    != observedEpoch
+                                    || shutdown.load(
+                                    std::memory_order_relaxed);
+                        });
+                    }
+                    sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    if (task != nullptr) {
+                        execute(task);
+                    }
+                    idleRounds = 0;
+                }
+            }
+        }
+
+        void wakeUp() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_seq_cst) > 0) {
+                std::lock_guard<std::mutex> lock(parkingMutex);
+                epoch.fetch_add(1, std::memory_order_seq_cst);
+                parkingCondition.notify_one();
+            }
+        }
+
+        void wakeUpAll() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_seq_cst) > 0) {
+                std::lock_guard<std::mutex> lock(parkingMutex);
+                epoch.fetch_add(1, std::memory_order_seq_cst);
+                parkingCondition.notify_all();
+            }
+        }
+
+    public:
+
+        WorkStealingPool(ssize_t const workersCount, bool const pinThreads)
+        : workersCount(std::max(workersCount, (ssize_t) 1)),
+        workers(this->workersCount), sleepers(0), epoch(0), shutdown(false),
+        pinned(pinThreads) {
+            for (ssize_t index = 0; index < this->workersCount; index++) {
+                workers[index].mailbox.store(nullptr,
+                        std::memory_order_relaxed);
+                workers[index].randomState = 0x9e3779b97f4a7c15ull
+                        * (index + 1);
+            }
+            for (ssize_t index = 1; index < this->workersCount; index++) {
+                threads.emplace_back(&WorkStealingPool::workerLoop, this,
+                        index);
+                if (pinThreads) {
+                    pin(threads.back().native_handle(), index);
+                }
+            }
+            if (pinThreads) {
+                pthread_getaffinity_np(pthread_self(), sizeof (cpu_set_t),
+                        &callerCpus);
+                pin(pthread_self(), 0);
+            }
+        }
+
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(parkingMutex);
+                shutdown.store(true, std::memory_order_release);
+                parkingCondition.notify_all();
+            }
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+            // threads created later inherit the mask of their creator
+            if (pinned) {
+                pthread_setaffinity_np(pthread_self(), sizeof (cpu_set_t),
+                        &callerCpus);
+            }
+        }
+
+        WorkStealingPool(WorkStealingPool const &) = delete;
+        WorkStealingPool & operator=(WorkStealingPool const &) = delete;
+
+        ssize_t size() const {
+            return workersCount;
+        }
+
+        /*
+         * the node the worker is pinned to, when the pool pins its threads;
+         * an index into numaTopology()
+         */
+        ssize_t workerNode(ssize_t const index) const {
+            return numaTopology().slotNode(index);
+        }
+
+        /*
+         * runs root on the calling thread as worker 0, so root can spawn
+         * tasks; calls must not overlap
+         */
+        template<typename Function>
+        void run(Function const &root) {
+            privateWorkStealingPool::CurrentWorker const saved =
+                    privateWorkStealingPool::currentWorker;
+            privateWorkStealingPool::currentWorker = {this, 0};
+            root();
+            privateWorkStealingPool::currentWorker = saved;
+        }
+
+        /*
+         * has to be called from inside run() or from a task
+         */
+        template<typename Function>
+        void spawn(std::atomic<ssize_t> * const pending,
+                Function const &function) {
+            assert(privateWorkStealingPool::currentWorker.pool == this);
+            Task * const task = new privateWorkStealingPool::FunctionTask<
+                    Function>(function);
+            task->pending = pending;
+            pending->fetch_add(1, std::memory_order_relaxed);
+            workers[privateWorkStealingPool::currentWorker.index].deque.push(
+                    task);
+            wakeUp();
+        }
+
+        /*
+         * executes other tasks until all tasks counted by pending are done
+         */
+        void wait(std::atomic<ssize_t> * const pending) {
+            ssize_t const index = privateWorkStealingPool::currentWorker.index;
+            while (pending->load(std::memory_order_acquire) > 0) {
+                Task * const task = findTask(index);
+                if (task != nullptr) {
+                    execute(task);
+                } else {
+                    _mm_pause();
+                }
+            }
+        }
+
+        /*
+         * calls function(worker) once on every worker, so the work lands
+         * next to memory placed for that worker; has to be called from
+         * inside run() or from a task and calls must not overlap
+         */
+        template<typename Function>
+        void onEachWorker(Function const &function) {
+            assert(privateWorkStealingPool::currentWorker.pool == this);
+            ssize_t const self = privateWorkStealingPool::currentWorker.index;
+            std::atomic<ssize_t> pending(0);
+            for (ssize_t index = 0; index < workersCount; index++) {
+                if (index != self) {
+                    Task * const task = new privateWorkStealingPool::
+                            FunctionTask<std::function<void()> >(
+                            [&function, index]() {
+                                function(index);
+                            });
+                    task->pending = &pending;
+                    pending.fetch_add(1, std::memory_order_relaxed);
+                    workers[index].mailbox.store(task,
+                            std::memory_order_release);
+                }
+            }
+            wakeUpAll();
+            function(self);
+            wait(&pending);
+        }
+
+        /*
+         * runs both functions, possibly in parallel, and returns when both
+         * are done
+         */
+        template<typename First, typename Second>
+        void invoke(First const &first, Second const &second) {
+            std::atomic<ssize_t> pending(0);
+            spawn(&pending, second);
+            first();
+            wait(&pending);
+        }
+
+        /*
+         * calls function(begin, end) on disjoint subranges of at most grain
+         * items, splitting the range recursively
+         */
+        template<typename Function>
+        void parallelFor(ssize_t const begin, ssize_t const end,
+                ssize_t const grain, Function const &function) {
+            if (end - begin <= grain) {
+                function(begin, end);
+            } else {
+                ssize_t const middle = begin + (end - begin) / 2;
+                invoke([&]() {
+                    parallelFor(begin, middle, grain, function);
+                }, [&]() {
+                    parallelFor(middle, end, grain, function);
+                });
+            }
+        }
+    };
+}
+
+#endif	/* WORKSTEALINGPOOL_HPP */